@@ -11,8 +11,17 @@ namespace fdo
 }
 
 #include "Format.h"
+#include "SharedBuffer.h"
+#include "DedupTable.h"
+#include "SIMD.h"
+#include "Parallel.h"
 
 #include "Point.h"
+#include "Mat5.h"
+#include "AABB4.h"
+#include "CellBounds.h"
+#include "Ray4.h"
+#include "Geometry.h"
 #include "Orientation.h"
 #include "TexCoord.h"
 #include "Color.h"
@@ -22,6 +31,19 @@ namespace fdo
 #include "Tetrahedron.h"
 #include "Cell.h"
 
+#include "CrossSection.h"
+#include "SliceIndex.h"
+#include "ProjectionMode.h"
+#include "Curve.h"
+#include "Dedup.h"
+#include "VertexLayout.h"
+#include "DrawRange.h"
+#include "TetrahedralizeScratch.h"
+#include "TetrahedralizeContext.h"
+#include "SpatialHash4.h"
+
 #include "Object.h"
+#include "BVH4.h"
+#include "KDTree4.h"
 
 #endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Point.h"
+
+namespace fdo
+{
+	// A 4D axis-aligned bounding box. A default-constructed box is empty (min > max).
+	struct AABB4
+	{
+		Point min = Point{ std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity() };
+		Point max = -min;
+
+		constexpr bool operator==(const AABB4& other) const { return min == other.min && max == other.max; }
+
+		bool isEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z || min.w > max.w; }
+
+		AABB4& expand(const Point& p)
+		{
+			min = { std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z), std::min(min.w, p.w) };
+			max = { std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z), std::max(max.w, p.w) };
+			return *this;
+		}
+		AABB4& expand(const AABB4& other)
+		{
+			if(other.isEmpty()) return *this;
+			expand(other.min);
+			expand(other.max);
+			return *this;
+		}
+
+		Point getCenter() const { return (min + max) * 0.5f; }
+		Point getSize() const { return isEmpty() ? Point{ 0,0,0,0 } : max - min; }
+
+		bool contains(const Point& p) const
+		{
+			return
+				p.x >= min.x && p.x <= max.x &&
+				p.y >= min.y && p.y <= max.y &&
+				p.z >= min.z && p.z <= max.z &&
+				p.w >= min.w && p.w <= max.w;
+		}
+		bool overlaps(const AABB4& other) const
+		{
+			return
+				min.x <= other.max.x && max.x >= other.min.x &&
+				min.y <= other.max.y && max.y >= other.min.y &&
+				min.z <= other.max.z && max.z >= other.min.z &&
+				min.w <= other.max.w && max.w >= other.min.w;
+		}
+
+		std::string toString() const
+		{
+			return std::format("[{}] - [{}]", min.toString(), max.toString());
+		}
+	};
+}
+
+namespace std
+{
+	inline ostream& operator<<(ostream& os, const fdo::AABB4& b)
+	{
+		return os << b.toString();
+	}
+	inline string to_string(const fdo::AABB4& b) noexcept
+	{
+		return b.toString();
+	}
+}
@@ -0,0 +1,737 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Point.h"
+#include "AABB4.h"
+#include "TexCoord.h"
+#include "Color.h"
+#include "Ray4.h"
+#include "Geometry.h"
+#include "Parallel.h"
+#include "Object.h"
+
+namespace fdo
+{
+	// The result of BVH4::closest.
+	struct ClosestTetrahedron
+	{
+		int32_t tetrahedron = -1; // Index of the closest tetrahedron, -1 if none was found.
+		Point point{ 0,0,0,0 }; // The closest point on it.
+		float distanceSqr = std::numeric_limits<float>::infinity(); // Squared distance to that point.
+		float barycentrics[4]{}; // Weights of the 4 tetrahedron corners at that point.
+
+		bool isFound() const { return tetrahedron >= 0; }
+	};
+
+	// The result of BVH4::sample: the closest point on the tetrahedra, with the attributes interpolated there.
+	struct Sample : ClosestTetrahedron
+	{
+		Point normal{ 0,0,0,0 };
+		TexCoord texCoord{ 0,0,0 };
+		Color color{ 0,0,0,0 };
+	};
+
+	/**
+	 * A bounding volume hierarchy over the tetrahedra of an Object.
+	 * Built top-down with binned SAH; the upper levels are split on the calling thread, the subtrees below them in parallel.
+	 * The nodes are stored in one flat array, with the two children of a node always next to each other.
+	 * Queries take the Object the hierarchy was built from. After the vertices move (`translate`, `scale`,
+	 * `applyTransform`, ...) call `refit`; after the tetrahedra change, `build` again.
+	 */
+	class BVH4
+	{
+	public:
+		struct Node
+		{
+			AABB4 bounds;
+			uint32_t offset = 0; // Leaves: first entry in the tetrahedron list. Inner nodes: index of the left child, the right one comes right after.
+			uint32_t count = 0; // Leaves: amount of tetrahedra. 0 for inner nodes.
+
+			bool isLeaf() const { return count != 0; }
+		};
+
+		inline static constexpr size_t binCount = 16;
+		inline static constexpr size_t maxDepth = 48; // deeper nodes get split at the median, which keeps query stacks small
+
+	private:
+		struct BuildTask
+		{
+			uint32_t node;
+			uint32_t begin;
+			uint32_t end;
+			size_t depth;
+		};
+
+		std::vector<Node> _nodes;
+		std::vector<uint32_t> _tetrahedra; // tetrahedron indices, ordered by leaf
+		size_t _maxLeafSize = 4;
+		uint64_t _verticesVersion = 0;
+		uint64_t _tetrahedraVersion = 0;
+
+		inline static constexpr size_t stackSize = maxDepth + 80;
+
+		// The corners of tetrahedron `t`. False if any index is invalid.
+		static bool corners(const Object& obj, uint32_t t, Point (&v)[4])
+		{
+			const std::vector<Point>& verts = obj.vertices.get();
+			const Tetrahedron& tet = obj.tetrahedra.get()[t];
+			for(int i = 0; i < 4; i++)
+			{
+				int32_t ind = tet.vIndices[i];
+				if(ind < 0 || ind >= (int32_t)verts.size())
+					return false;
+				v[i] = verts[ind];
+			}
+			return true;
+		}
+
+		static AABB4 tetrahedronBounds(const Object& obj, uint32_t t)
+		{
+			AABB4 b;
+			Point v[4];
+			if(corners(obj, t, v))
+				b.expand(v[0]).expand(v[1]).expand(v[2]).expand(v[3]);
+			return b;
+		}
+
+		/**
+		 * Builds the subtree of `node` over `_tetrahedra[begin, end)`.
+		 * If `deferred` isn't null, ranges small enough to be built on their own are left as placeholders and added to it instead.
+		 */
+		void buildNode(std::vector<Node>& nodes, uint32_t node, uint32_t begin, uint32_t end, size_t depth,
+			const std::vector<AABB4>& bounds, const std::vector<Point>& centroids, std::vector<BuildTask>* deferred)
+		{
+			const uint32_t count = end - begin;
+			if(deferred && count <= std::max<size_t>(Parallel::getChunkSize() / 4, 1))
+			{
+				deferred->push_back({ node, begin, end, depth });
+				return;
+			}
+
+			AABB4 box;
+			AABB4 centroidBox;
+			for(uint32_t i = begin; i < end; i++)
+			{
+				box.expand(bounds[_tetrahedra[i]]);
+				centroidBox.expand(centroids[_tetrahedra[i]]);
+			}
+			nodes[node].bounds = box;
+
+			if(count <= _maxLeafSize)
+			{
+				nodes[node].offset = begin;
+				nodes[node].count = count;
+				return;
+			}
+
+			const float* cMin = &centroidBox.min.x;
+			const Point extent = centroidBox.getSize();
+			const float* ext = &extent.x;
+			// bins per unit along every axis, 0 for axes too flat to bin (a denormal extent would make it infinite)
+			float binScale[4];
+			for(int axis = 0; axis < 4; axis++)
+			{
+				const float scale = (float)binCount / ext[axis];
+				binScale[axis] = ext[axis] >= std::numeric_limits<float>::min() && std::isfinite(scale) ? scale : 0.f;
+			}
+			auto binOf = [&](uint32_t t, int axis)
+				{
+					const float* c = &centroids[t].x;
+					return std::min(binCount - 1, (size_t)((c[axis] - cMin[axis]) * binScale[axis]));
+				};
+
+			// binned SAH over all 4 axes
+			int bestAxis = -1;
+			size_t bestBin = 0;
+			float bestCost = std::numeric_limits<float>::infinity();
+			if(depth < maxDepth)
+			{
+				for(int axis = 0; axis < 4; axis++)
+				{
+					if(binScale[axis] == 0.f)
+						continue;
+
+					AABB4 binBounds[binCount];
+					uint32_t binCounts[binCount]{};
+					for(uint32_t i = begin; i < end; i++)
+					{
+						size_t b = binOf(_tetrahedra[i], axis);
+						binBounds[b].expand(bounds[_tetrahedra[i]]);
+						binCounts[b]++;
+					}
+
+					// sweep from the right, then from the left, costing every split between bins
+					float rightArea[binCount];
+					uint32_t rightCount[binCount];
+					AABB4 acc;
+					uint32_t n = 0;
+					for(size_t b = binCount - 1; b > 0; b--)
+					{
+						acc.expand(binBounds[b]);
+						n += binCounts[b];
+						rightArea[b] = geometry::halfBoundary(acc);
+						rightCount[b] = n;
+					}
+					acc = AABB4{};
+					n = 0;
+					for(size_t b = 1; b < binCount; b++)
+					{
+						acc.expand(binBounds[b - 1]);
+						n += binCounts[b - 1];
+						if(n == 0 || rightCount[b] == 0)
+							continue;
+						float cost = geometry::halfBoundary(acc) * n + rightArea[b] * rightCount[b];
+						if(cost < bestCost)
+						{
+							bestCost = cost;
+							bestAxis = axis;
+							bestBin = b;
+						}
+					}
+				}
+			}
+
+			uint32_t mid;
+			if(bestAxis >= 0)
+			{
+				mid = (uint32_t)(std::partition(_tetrahedra.begin() + begin, _tetrahedra.begin() + end,
+					[&](uint32_t t) { return binOf(t, bestAxis) < bestBin; }) - _tetrahedra.begin());
+			}
+			else
+			{
+				// no useful split (or too deep), split at the median of the longest centroid axis
+				int axis = 0;
+				for(int i = 1; i < 4; i++)
+					if(ext[i] > ext[axis]) axis = i;
+				mid = begin + count / 2;
+				std::nth_element(_tetrahedra.begin() + begin, _tetrahedra.begin() + mid, _tetrahedra.begin() + end,
+					[&](uint32_t a, uint32_t b)
+					{
+						float ca = (&centroids[a].x)[axis];
+						float cb = (&centroids[b].x)[axis];
+						return ca < cb || (ca == cb && a < b);
+					});
+			}
+
+			const uint32_t left = (uint32_t)nodes.size();
+			nodes.resize(nodes.size() + 2);
+			nodes[node].offset = left;
+			nodes[node].count = 0;
+			buildNode(nodes, left, begin, mid, depth + 1, bounds, centroids, deferred);
+			buildNode(nodes, left + 1, mid, end, depth + 1, bounds, centroids, deferred);
+		}
+
+		// Traces up to `packetSize` rays together, culling nodes only when all of them miss.
+		void raycastPacket(const Object& obj, std::span<const Ray4> rays, std::span<Hit> hits) const
+		{
+			const size_t n = rays.size();
+			// structure-of-arrays, so the per-lane loops vectorize
+			float o[4][packetSize]{};
+			float d[4][packetSize]{};
+			float inv[4][packetSize];
+			float tMin[packetSize];
+			float tMax[packetSize];
+			for(size_t l = 0; l < packetSize; l++)
+			{
+				if(l < n)
+				{
+					const float* ro = &rays[l].origin.x;
+					const float* rd = &rays[l].direction.x;
+					for(int k = 0; k < 4; k++)
+					{
+						o[k][l] = ro[k];
+						d[k][l] = rd[k];
+						inv[k][l] = 1.f / rd[k];
+					}
+					tMin[l] = rays[l].tMin;
+					tMax[l] = rays[l].tMax;
+					hits[l] = Hit{};
+				}
+				else
+				{
+					// unused lanes have an empty range, so they never hit anything
+					for(int k = 0; k < 4; k++)
+						inv[k][l] = 1.f;
+					tMin[l] = std::numeric_limits<float>::infinity();
+					tMax[l] = -std::numeric_limits<float>::infinity();
+				}
+			}
+
+			auto anyLaneHits = [&](const AABB4& box)
+				{
+					const float* lo = &box.min.x;
+					const float* hi = &box.max.x;
+					bool any = false;
+					for(size_t l = 0; l < packetSize; l++)
+					{
+						float near = tMin[l];
+						float far = tMax[l];
+						for(int k = 0; k < 4; k++)
+						{
+							float t0 = (lo[k] - o[k][l]) * inv[k][l];
+							float t1 = (hi[k] - o[k][l]) * inv[k][l];
+							float tn = t0 < t1 ? t0 : t1;
+							float tf = t0 < t1 ? t1 : t0;
+							near = tn > near ? tn : near;
+							far = tf < far ? tf : far;
+						}
+						any |= near <= far;
+					}
+					return any;
+				};
+
+			uint32_t stack[stackSize];
+			size_t top = 0;
+			stack[top++] = 0;
+			while(top > 0)
+			{
+				const Node& node = _nodes[stack[--top]];
+				if(!anyLaneHits(node.bounds))
+					continue;
+
+				if(!node.isLeaf())
+				{
+					// visit the child lying further along the first ray's direction last
+					const Point delta = _nodes[node.offset + 1].bounds.getCenter() - _nodes[node.offset].bounds.getCenter();
+					const bool leftFirst = delta.x * d[0][0] + delta.y * d[1][0] + delta.z * d[2][0] + delta.w * d[3][0] >= 0.f;
+					stack[top++] = leftFirst ? node.offset + 1 : node.offset;
+					stack[top++] = leftFirst ? node.offset : node.offset + 1;
+					continue;
+				}
+
+				for(uint32_t j = node.offset; j < node.offset + node.count; j++)
+				{
+					const int32_t tet = (int32_t)_tetrahedra[j];
+					Point v[4];
+					Point normal, dual[3];
+					if(!corners(obj, tet, v) || !geometry::tetrahedronFrame(v[0], v[1], v[2], v[3], normal, dual))
+						continue;
+
+					const float* a = &v[0].x;
+					const float* nm = &normal.x;
+					const float* du[3] = { &dual[0].x, &dual[1].x, &dual[2].x };
+					for(size_t l = 0; l < n; l++)
+					{
+						float denom = 0.f, num = 0.f;
+						for(int k = 0; k < 4; k++)
+						{
+							denom += nm[k] * d[k][l];
+							num += nm[k] * (a[k] - o[k][l]);
+						}
+						if(std::abs(denom) <= 1e-20f)
+							continue;
+						const float t = num / denom;
+						if(!(t >= tMin[l] && t <= tMax[l]))
+							continue;
+						if(t == tMax[l] && hits[l].isHit() && tet > hits[l].tetrahedron)
+							continue;
+
+						float u[3]{};
+						for(int k = 0; k < 4; k++)
+						{
+							const float s = o[k][l] - a[k] + d[k][l] * t;
+							u[0] += du[0][k] * s;
+							u[1] += du[1][k] * s;
+							u[2] += du[2][k] * s;
+						}
+						const float u0 = 1.f - u[0] - u[1] - u[2];
+						if(u0 < 0.f || u[0] < 0.f || u[1] < 0.f || u[2] < 0.f)
+							continue;
+
+						tMax[l] = t;
+						hits[l].t = t;
+						hits[l].tetrahedron = tet;
+						hits[l].barycentrics[0] = u0;
+						hits[l].barycentrics[1] = u[0];
+						hits[l].barycentrics[2] = u[1];
+						hits[l].barycentrics[3] = u[2];
+					}
+				}
+			}
+		}
+
+	public:
+		inline static constexpr size_t packetSize = 8;
+
+		BVH4() = default;
+		BVH4(const Object& obj, size_t maxLeafSize = 4) { build(obj, maxLeafSize); }
+
+		/**
+		 * (Re)builds the hierarchy over all tetrahedra of `obj`. Tetrahedra with invalid vertex indices are left out.
+		 * The result doesn't depend on the thread count.
+		 * @param maxLeafSize The most tetrahedra a leaf can hold.
+		 */
+		void build(const Object& obj, size_t maxLeafSize = 4)
+		{
+			_maxLeafSize = std::max<size_t>(maxLeafSize, 1);
+			_nodes.clear();
+			_tetrahedra.clear();
+			_verticesVersion = obj.vertices.version();
+			_tetrahedraVersion = obj.tetrahedra.version();
+
+			const size_t tetCount = obj.tetrahedra.size();
+			std::vector<AABB4> bounds(tetCount);
+			std::vector<Point> centroids(tetCount);
+			Parallel::forChunks(tetCount, [&](size_t begin, size_t end)
+				{
+					for(size_t i = begin; i < end; i++)
+					{
+						bounds[i] = tetrahedronBounds(obj, (uint32_t)i);
+						centroids[i] = bounds[i].getCenter();
+					}
+				});
+
+			_tetrahedra.reserve(tetCount);
+			for(uint32_t i = 0; i < tetCount; i++)
+				if(!bounds[i].isEmpty())
+					_tetrahedra.push_back(i);
+			if(_tetrahedra.empty())
+				return;
+
+			// split the upper levels here, then build the small subtrees below them in parallel
+			std::vector<BuildTask> tasks;
+			_nodes.reserve(_tetrahedra.size() * 2 / _maxLeafSize + 1);
+			_nodes.resize(1);
+			buildNode(_nodes, 0, 0, (uint32_t)_tetrahedra.size(), 0, bounds, centroids, &tasks);
+
+			std::vector<std::vector<Node>> subtrees(tasks.size());
+			Parallel::forChunks(tasks.size(), [&](size_t begin, size_t end)
+				{
+					for(size_t i = begin; i < end; i++)
+					{
+						subtrees[i].resize(1);
+						buildNode(subtrees[i], 0, tasks[i].begin, tasks[i].end, tasks[i].depth, bounds, centroids, nullptr);
+					}
+				}, 1);
+
+			// splice the subtrees in, in task order, so the layout is the same no matter which thread built what
+			for(size_t i = 0; i < tasks.size(); i++)
+			{
+				const uint32_t base = (uint32_t)_nodes.size() - 1; // local node j > 0 ends up at base + j
+				auto rebased = [base](Node n)
+					{
+						if(!n.isLeaf())
+							n.offset += base;
+						return n;
+					};
+				_nodes[tasks[i].node] = rebased(subtrees[i][0]);
+				for(size_t j = 1; j < subtrees[i].size(); j++)
+					_nodes.push_back(rebased(subtrees[i][j]));
+			}
+		}
+
+		/**
+		 * Updates the node bounds after the vertices of `obj` moved. Keeps the tree structure, so queries
+		 * get slower if the vertices moved a lot relative to each other; `build` again in that case.
+		 * The tetrahedra have to be the same as when the hierarchy was built.
+		 */
+		void refit(const Object& obj)
+		{
+			if(_nodes.empty())
+				return;
+
+			Parallel::forChunks(_nodes.size(), [&](size_t begin, size_t end)
+				{
+					for(size_t i = begin; i < end; i++)
+					{
+						Node& n = _nodes[i];
+						if(!n.isLeaf())
+							continue;
+						n.bounds = AABB4{};
+						for(uint32_t j = n.offset; j < n.offset + n.count; j++)
+							n.bounds.expand(tetrahedronBounds(obj, _tetrahedra[j]));
+					}
+				});
+			// children always come after their parent
+			for(size_t i = _nodes.size(); i-- > 0;)
+			{
+				Node& n = _nodes[i];
+				if(!n.isLeaf())
+					n.bounds = AABB4{ _nodes[n.offset].bounds }.expand(_nodes[n.offset + 1].bounds);
+			}
+			_verticesVersion = obj.vertices.version();
+		}
+
+		// Whether the vertices of `obj` changed since the last `build` or `refit`.
+		bool needsRefit(const Object& obj) const { return obj.vertices.version() != _verticesVersion; }
+		// Whether the tetrahedra of `obj` changed since the last `build`.
+		bool needsRebuild(const Object& obj) const { return obj.tetrahedra.version() != _tetrahedraVersion; }
+
+		const std::vector<Node>& getNodes() const { return _nodes; }
+		// The tetrahedron indices the leaves point into.
+		const std::vector<uint32_t>& getTetrahedra() const { return _tetrahedra; }
+		bool empty() const { return _nodes.empty(); }
+		AABB4 getBounds() const { return _nodes.empty() ? AABB4{} : _nodes[0].bounds; }
+
+		/**
+		 * Finds the tetrahedra whose bounding boxes overlap `box`.
+		 * @param out The indices of the tetrahedra. Gets cleared first.
+		 */
+		void overlapping(const Object& obj, const AABB4& box, std::vector<uint32_t>& out) const
+		{
+			out.clear();
+			if(_nodes.empty() || !box.overlaps(_nodes[0].bounds))
+				return;
+
+			uint32_t stack[stackSize];
+			size_t top = 0;
+			stack[top++] = 0;
+			while(top > 0)
+			{
+				const Node& n = _nodes[stack[--top]];
+				if(n.isLeaf())
+				{
+					for(uint32_t j = n.offset; j < n.offset + n.count; j++)
+						if(tetrahedronBounds(obj, _tetrahedra[j]).overlaps(box))
+							out.push_back(_tetrahedra[j]);
+					continue;
+				}
+				// push the right child first so the left one is visited first
+				if(_nodes[n.offset + 1].bounds.overlaps(box))
+					stack[top++] = n.offset + 1;
+				if(_nodes[n.offset].bounds.overlaps(box))
+					stack[top++] = n.offset;
+			}
+		}
+
+		/**
+		 * Finds the point on the tetrahedra closest to `p`.
+		 * @param maxDistance Tetrahedra further away than this are ignored.
+		 */
+		ClosestTetrahedron closest(const Object& obj, const Point& p, float maxDistance = std::numeric_limits<float>::infinity()) const
+		{
+			ClosestTetrahedron result;
+			result.distanceSqr = maxDistance < std::numeric_limits<float>::infinity() ? maxDistance * maxDistance : maxDistance;
+			if(_nodes.empty())
+				return result;
+
+			uint32_t stack[stackSize];
+			size_t top = 0;
+			stack[top++] = 0;
+			while(top > 0)
+			{
+				const Node& n = _nodes[stack[--top]];
+				if(geometry::distanceSqr(n.bounds, p) > result.distanceSqr)
+					continue;
+				if(n.isLeaf())
+				{
+					for(uint32_t j = n.offset; j < n.offset + n.count; j++)
+					{
+						Point v[4];
+						if(!corners(obj, _tetrahedra[j], v))
+							continue;
+						float bc[4];
+						Point q = geometry::closestPointOnTetrahedron(p, v[0], v[1], v[2], v[3], bc);
+						float d = Point::lengthSqr(q - p);
+						// ties go to the lower index, so the result doesn't depend on the tree layout
+						if(d < result.distanceSqr || (d == result.distanceSqr && result.isFound() && (int32_t)_tetrahedra[j] < result.tetrahedron))
+						{
+							result.distanceSqr = d;
+							result.tetrahedron = (int32_t)_tetrahedra[j];
+							result.point = q;
+							std::copy(bc, bc + 4, result.barycentrics);
+						}
+					}
+					continue;
+				}
+				// visit the nearer child first
+				uint32_t a = n.offset;
+				uint32_t b = n.offset + 1;
+				float da = geometry::distanceSqr(_nodes[a].bounds, p);
+				float db = geometry::distanceSqr(_nodes[b].bounds, p);
+				if(da < db)
+				{
+					std::swap(a, b);
+					std::swap(da, db);
+				}
+				if(da <= result.distanceSqr) stack[top++] = a;
+				if(db <= result.distanceSqr) stack[top++] = b;
+			}
+			return result;
+		}
+
+		/**
+		 * Samples the attributes of `obj` at many points: finds the tetrahedron containing each point (or the closest one)
+		 * and interpolates its corner normals, texture coordinates and colors there. Points run in parallel.
+		 * @param points The points to sample at.
+		 * @param out The output, one per point. Has to be at least as large as `points`.
+		 * @param attributes Which attributes to interpolate. The others are left at zero.
+		 * @param maxDistance Points further away from every tetrahedron than this aren't found (`isFound()` is false).
+		 */
+		void sample(const Object& obj, std::span<const Point> points, std::span<Sample> out, DataMask attributes = DataMask::All, float maxDistance = std::numeric_limits<float>::infinity()) const
+		{
+			if(out.size() < points.size())
+			{
+				Logger::logError(std::format("fdo::BVH4::sample: Output span is too small ({} samples for {} points).", out.size(), points.size()));
+				return;
+			}
+
+			Parallel::forChunks(points.size(), [&](size_t begin, size_t end)
+				{
+					for(size_t i = begin; i < end; i++)
+					{
+						Sample& s = out[i];
+						s = Sample{};
+						static_cast<ClosestTetrahedron&>(s) = closest(obj, points[i], maxDistance);
+						if(!s.isFound())
+							continue;
+						obj.interpolate(s.tetrahedron, s.barycentrics,
+							hasData(attributes, FDataType::vn) ? &s.normal : nullptr,
+							hasData(attributes, FDataType::vt) ? &s.texCoord : nullptr,
+							hasData(attributes, FDataType::co) ? &s.color : nullptr);
+					}
+				}, 256);
+		}
+
+		/**
+		 * Finds the first tetrahedron hit by `ray`.
+		 * @returns The hit. `Hit::isHit()` is false if nothing got hit.
+		 */
+		Hit raycast(const Object& obj, const Ray4& ray) const
+		{
+			Hit hit;
+			if(_nodes.empty())
+				return hit;
+
+			const Point invDir = Point{ 1,1,1,1 } / ray.direction;
+			float tMax = ray.tMax;
+			float tEnter;
+
+			uint32_t stack[stackSize];
+			size_t top = 0;
+			if(geometry::intersectAABB(ray.origin, invDir, _nodes[0].bounds, ray.tMin, tMax, tEnter))
+				stack[top++] = 0;
+			while(top > 0)
+			{
+				const Node& n = _nodes[stack[--top]];
+				if(n.isLeaf())
+				{
+					for(uint32_t j = n.offset; j < n.offset + n.count; j++)
+					{
+						Point v[4];
+						float t, bc[4];
+						if(!corners(obj, _tetrahedra[j], v) || !geometry::intersectTetrahedron(ray.origin, ray.direction, v[0], v[1], v[2], v[3], t, bc))
+							continue;
+						if(t < ray.tMin || t > tMax)
+							continue;
+						if(t == tMax && hit.isHit() && (int32_t)_tetrahedra[j] > hit.tetrahedron)
+							continue;
+						tMax = t;
+						hit.t = t;
+						hit.tetrahedron = (int32_t)_tetrahedra[j];
+						std::copy(bc, bc + 4, hit.barycentrics);
+					}
+					continue;
+				}
+				// visit the nearer child first
+				uint32_t a = n.offset;
+				uint32_t b = n.offset + 1;
+				float ta, tb;
+				bool hitA = geometry::intersectAABB(ray.origin, invDir, _nodes[a].bounds, ray.tMin, tMax, ta);
+				bool hitB = geometry::intersectAABB(ray.origin, invDir, _nodes[b].bounds, ray.tMin, tMax, tb);
+				if(hitA && hitB && ta < tb)
+				{
+					stack[top++] = b;
+					stack[top++] = a;
+				}
+				else if(hitA && hitB)
+				{
+					stack[top++] = a;
+					stack[top++] = b;
+				}
+				else if(hitA) stack[top++] = a;
+				else if(hitB) stack[top++] = b;
+			}
+			return hit;
+		}
+
+		/**
+		 * Finds the first tetrahedron hit by every ray. Consecutive rays are traced together in packets of
+		 * `packetSize`, so keep rays that go in similar directions next to each other. Packets run in parallel.
+		 * @param hits The output, one per ray. Has to be at least as large as `rays`.
+		 */
+		void raycast(const Object& obj, std::span<const Ray4> rays, std::span<Hit> hits) const
+		{
+			if(hits.size() < rays.size())
+			{
+				Logger::logError(std::format("fdo::BVH4::raycast: Output span is too small ({} hits for {} rays).", hits.size(), rays.size()));
+				return;
+			}
+			if(_nodes.empty())
+			{
+				std::fill(hits.begin(), hits.begin() + rays.size(), Hit{});
+				return;
+			}
+
+			Parallel::forChunks(rays.size(), [&](size_t begin, size_t end)
+				{
+					for(size_t p = begin; p < end; p += packetSize)
+					{
+						const size_t count = std::min(packetSize, end - p);
+						raycastPacket(obj, rays.subspan(p, count), hits.subspan(p, count));
+					}
+				}, packetSize * 32);
+		}
+
+		/**
+		 * Finds every tetrahedron hit by `ray`.
+		 * @param out The hits, sorted by distance along the ray. Gets cleared first.
+		 */
+		void raycastAll(const Object& obj, const Ray4& ray, std::vector<Hit>& out) const
+		{
+			out.clear();
+			if(_nodes.empty())
+				return;
+
+			const Point invDir = Point{ 1,1,1,1 } / ray.direction;
+			float tEnter;
+
+			uint32_t stack[stackSize];
+			size_t top = 0;
+			stack[top++] = 0;
+			while(top > 0)
+			{
+				const Node& n = _nodes[stack[--top]];
+				if(!geometry::intersectAABB(ray.origin, invDir, n.bounds, ray.tMin, ray.tMax, tEnter))
+					continue;
+				if(n.isLeaf())
+				{
+					for(uint32_t j = n.offset; j < n.offset + n.count; j++)
+					{
+						Point v[4];
+						Hit hit;
+						if(!corners(obj, _tetrahedra[j], v) || !geometry::intersectTetrahedron(ray.origin, ray.direction, v[0], v[1], v[2], v[3], hit.t, hit.barycentrics))
+							continue;
+						if(hit.t < ray.tMin || hit.t > ray.tMax)
+							continue;
+						hit.tetrahedron = (int32_t)_tetrahedra[j];
+						out.push_back(hit);
+					}
+					continue;
+				}
+				stack[top++] = n.offset + 1;
+				stack[top++] = n.offset;
+			}
+
+			std::sort(out.begin(), out.end(), [](const Hit& a, const Hit& b) { return a.t < b.t || (a.t == b.t && a.tetrahedron < b.tetrahedron); });
+		}
+	};
+
+	/**
+	 * Finds the first tetrahedron of `obj` hit by every ray, using `bvh` (built from `obj`).
+	 * @see fdo::BVH4::raycast
+	 */
+	inline void raycast(const BVH4& bvh, const Object& obj, std::span<const Ray4> rays, std::span<Hit> hits)
+	{
+		bvh.raycast(obj, rays, hits);
+	}
+	/**
+	 * Finds the first tetrahedron of `obj` hit by every ray.
+	 * Builds a BVH4 first, so when casting into the same Object repeatedly, keep one around and use the other overload.
+	 * @see fdo::BVH4::raycast
+	 */
+	inline void raycast(const Object& obj, std::span<const Ray4> rays, std::span<Hit> hits)
+	{
+		BVH4(obj).raycast(obj, rays, hits);
+	}
+}
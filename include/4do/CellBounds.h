@@ -0,0 +1,79 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Point.h"
+#include "AABB4.h"
+
+namespace fdo
+{
+	// A hyperplane `dot(normal, p) == offset`. When culling against it, the side `dot(normal, p) > offset` is outside.
+	struct Hyperplane4
+	{
+		Point normal{ 0,0,0,1 }; // Doesn't have to be normalized.
+		float offset = 0;
+	};
+
+	/**
+	 * The bounding volumes of one Cell's vertices, see Object::getCellBounds.
+	 * Cells without any valid vertex get an empty box and a negative radius, and never pass a culling test.
+	 */
+	struct CellBounds
+	{
+		AABB4 box;
+		Point center{ 0,0,0,0 }; // The center of the bounding sphere, which is also the center of the box.
+		float radius = -1.f;
+
+		bool isEmpty() const { return radius < 0.f; }
+
+		// Whether the cell might cross `plane`.
+		bool crosses(const Hyperplane4& plane) const
+		{
+			if(isEmpty())
+				return false;
+			const float d = Point::dot(plane.normal, center) - plane.offset;
+			const float r = radius * Point::length(plane.normal);
+			if(d > r || d < -r)
+				return false;
+			float lo, hi;
+			project(plane.normal, lo, hi);
+			return lo <= plane.offset && hi >= plane.offset;
+		}
+		// Whether the cell might reach into the inside of `plane`.
+		bool inside(const Hyperplane4& plane) const
+		{
+			if(isEmpty())
+				return false;
+			if(Point::dot(plane.normal, center) - plane.offset > radius * Point::length(plane.normal))
+				return false;
+			float lo, hi;
+			project(plane.normal, lo, hi);
+			return lo <= plane.offset;
+		}
+
+		// The range of `dot(normal, p)` over the box.
+		void project(const Point& normal, float& lo, float& hi) const
+		{
+			const float n[4] = { normal.x, normal.y, normal.z, normal.w };
+			const float mn[4] = { box.min.x, box.min.y, box.min.z, box.min.w };
+			const float mx[4] = { box.max.x, box.max.y, box.max.z, box.max.w };
+			lo = hi = 0.f;
+			for(int i = 0; i < 4; i++)
+			{
+				lo += n[i] * (n[i] >= 0.f ? mn[i] : mx[i]);
+				hi += n[i] * (n[i] >= 0.f ? mx[i] : mn[i]);
+			}
+		}
+	};
+
+	/**
+	 * The output of Object::cullCells. Owned by the caller. Keep one around and pass it again every frame,
+	 * the buffers get reused so culling doesn't allocate once their capacity has grown large enough.
+	 */
+	struct CulledCells
+	{
+		std::vector<uint32_t> cells; // The cell indices, ascending.
+
+		// scratch buffers, reused between calls
+		std::vector<size_t> chunkOffsets; // The first output cell of each chunk.
+	};
+}
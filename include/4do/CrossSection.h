@@ -0,0 +1,45 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Point.h"
+#include "TexCoord.h"
+#include "Color.h"
+#include "CellBounds.h"
+
+namespace fdo
+{
+	/**
+	 * The output of Object::slice: the triangles where an Object's tetrahedra intersect a hyperplane.
+	 * Owned by the caller. Keep one around and pass it again every frame, the buffers get reused so
+	 * slicing doesn't allocate once their capacity has grown large enough.
+	 */
+	struct CrossSection
+	{
+		std::vector<uint32_t> indices; // Triangle list indices.
+		std::vector<Point> positions; // Vertex positions. They all lie on the hyperplane.
+		std::vector<Point> normals; // Interpolated vertex normals. Only filled if requested.
+		std::vector<TexCoord> texCoords; // Interpolated texture coordinates. Only filled if requested.
+		std::vector<Color> colors; // Interpolated colors. Only filled if requested.
+		std::vector<int32_t> triangleTetrahedra; // The tetrahedron each triangle was cut from.
+
+		// scratch buffers, reused between calls
+		std::vector<float> distances; // Signed distance of each Object vertex to the hyperplane. Object::sliceCells only fills the ones it needs.
+		std::vector<std::pair<size_t, size_t>> chunkOffsets; // (first vertex, first triangle) of each chunk.
+		CulledCells culled; // The cells left after culling, for Object::sliceCells.
+		std::vector<uint32_t> tetrahedra; // The tetrahedra of those cells, for Object::sliceCells.
+		std::vector<uint8_t> listed; // Which tetrahedra are in `tetrahedra`, all zero between calls.
+
+		size_t triangleCount() const { return indices.size() / 3; }
+
+		// Clears the results, but keeps the capacity.
+		void clear()
+		{
+			indices.clear();
+			positions.clear();
+			normals.clear();
+			texCoords.clear();
+			colors.clear();
+			triangleTetrahedra.clear();
+		}
+	};
+}
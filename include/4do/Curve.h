@@ -0,0 +1,58 @@
+#pragma once
+
+#include "basicIncludes.h"
+
+namespace fdo
+{
+	// 4D space-filling curves, used to sort elements so that ones close in space end up close in memory.
+	enum class Curve : uint8_t
+	{
+		Morton4D, // Z-order. Cheapest to compute.
+		Hilbert4D, // Never jumps between far apart cells, so it keeps locality a bit better than Morton.
+	};
+
+	/**
+	 * The position along `curve` of a cell in a 65536^4 grid.
+	 * @param cell The cell coordinates. Only the lower 16 bits are used.
+	 */
+	inline uint64_t curveKey(Curve curve, const uint32_t (&cell)[4])
+	{
+		constexpr int bits = 16;
+		uint32_t x[4] = { cell[0] & 0xFFFF, cell[1] & 0xFFFF, cell[2] & 0xFFFF, cell[3] & 0xFFFF };
+
+		if(curve == Curve::Hilbert4D)
+		{
+			// Skilling's "axes to transpose" transform (Programming the Hilbert curve, 2004)
+			for(uint32_t q = 1u << (bits - 1); q > 1; q >>= 1)
+			{
+				const uint32_t p = q - 1;
+				for(int i = 0; i < 4; i++)
+				{
+					if(x[i] & q)
+						x[0] ^= p;
+					else
+					{
+						uint32_t t = (x[0] ^ x[i]) & p;
+						x[0] ^= t;
+						x[i] ^= t;
+					}
+				}
+			}
+			for(int i = 1; i < 4; i++)
+				x[i] ^= x[i - 1];
+			uint32_t t = 0;
+			for(uint32_t q = 1u << (bits - 1); q > 1; q >>= 1)
+				if(x[3] & q)
+					t ^= q - 1;
+			for(int i = 0; i < 4; i++)
+				x[i] ^= t;
+		}
+
+		// interleave the bits, most significant first
+		uint64_t key = 0;
+		for(int b = bits - 1; b >= 0; b--)
+			for(int i = 0; i < 4; i++)
+				key = (key << 1) | ((x[i] >> b) & 1);
+		return key;
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Format.h"
+#include "Point.h"
+#include "TexCoord.h"
+#include "Color.h"
+#include "DedupTable.h"
+
+namespace fdo
+{
+	// How Object::tetrahedralize merges the corners of the tetrahedra into shared vertices.
+	enum class Dedup : uint8_t
+	{
+		None, // Every corner gets its own vertex.
+		ByValue, // Corners with equal attribute values share a vertex.
+		ByIndex, // Corners with equal (v, vn, vt, co) indices share a vertex. Faster, but equal values stored twice stay apart.
+	};
+
+	// The hash of a vertex under Dedup::ByIndex, from its (v, vn, vt, co) indices (-1 where invalid or not requested).
+	inline uint64_t hashVertexIndices(const std::array<int32_t, 4>& t)
+	{
+		return HashBuilder()
+			.add((uint64_t)(uint32_t)t[0] | (uint64_t)(uint32_t)t[1] << 32)
+			.add((uint64_t)(uint32_t)t[2] | (uint64_t)(uint32_t)t[3] << 32)
+			.get();
+	}
+
+	// The hash of a vertex under Dedup::ByValue. Only the `attributes` are hashed, missing data should be zeroes.
+	inline uint64_t hashVertexValues(DataMask attributes, const Point& pos, const Point& norm, const TexCoord& uvw, const Color& col)
+	{
+		HashBuilder h;
+		if(hasData(attributes, FDataType::v))
+			h.add(pos.x).add(pos.y).add(pos.z).add(pos.w);
+		if(hasData(attributes, FDataType::vn))
+			h.add(norm.x).add(norm.y).add(norm.z).add(norm.w);
+		if(hasData(attributes, FDataType::vt))
+			h.add(uvw.u).add(uvw.v).add(uvw.w);
+		if(hasData(attributes, FDataType::co))
+			h.add((uint64_t)col.r | (uint64_t)col.g << 8 | (uint64_t)col.b << 16 | (uint64_t)col.a << 24);
+		return h.get();
+	}
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "basicIncludes.h"
+
+namespace fdo
+{
+	/**
+	 * A flat open-addressing hash table giving every distinct key a dense index, in insertion order.
+	 * Slots only hold a 32-bit key index and the keys (plus their hashes) live in one array, so inserting
+	 * never allocates per entry and every key is hashed exactly once, growth included.
+	 * `Hash` has to return a well mixed 64-bit value, the table uses its low bits directly.
+	 */
+	template<typename Key, typename Hash, typename Equal = std::equal_to<Key>>
+	class DedupTable
+	{
+	private:
+		inline static constexpr uint32_t empty = std::numeric_limits<uint32_t>::max();
+
+		std::vector<uint32_t> _slots; // key index, or `empty`
+		std::vector<Key> _keys;
+		std::vector<uint64_t> _hashes; // hash of every key, for cheap mismatches and rehashing
+		size_t _mask = 0;
+		Hash _hash{};
+		Equal _equal{};
+
+		void rehash(size_t slotCount)
+		{
+			_slots.assign(slotCount, empty);
+			_mask = slotCount - 1;
+			for(uint32_t i = 0; i < _keys.size(); i++)
+			{
+				size_t s = _hashes[i] & _mask;
+				while(_slots[s] != empty)
+					s = (s + 1) & _mask;
+				_slots[s] = i;
+			}
+		}
+
+	public:
+		DedupTable() = default;
+		DedupTable(size_t expectedKeys, Hash hash = {}, Equal equal = {}) : _hash(std::move(hash)), _equal(std::move(equal)) { reserve(expectedKeys); }
+
+		// Makes room for `count` keys without growing (the table stays at most half full).
+		void reserve(size_t count)
+		{
+			size_t slotCount = 16;
+			while(slotCount < count * 2)
+				slotCount <<= 1;
+			_keys.reserve(count);
+			_hashes.reserve(count);
+			if(slotCount > _slots.size())
+				rehash(slotCount);
+		}
+
+		// Replaces the hash and equality functions, e.g. when they point into data that moved. Doesn't rehash anything.
+		void setFunctions(Hash hash, Equal equal = {})
+		{
+			_hash = std::move(hash);
+			_equal = std::move(equal);
+		}
+
+		// Removes all keys, but keeps the memory.
+		void clear()
+		{
+			std::fill(_slots.begin(), _slots.end(), empty);
+			_keys.clear();
+			_hashes.clear();
+		}
+
+		size_t size() const { return _keys.size(); }
+		// The distinct keys, in insertion order. The index of a key is its position in here.
+		const std::vector<Key>& keys() const { return _keys; }
+		const std::vector<uint64_t>& hashes() const { return _hashes; }
+
+		uint64_t hash(const Key& key) const { return _hash(key); }
+
+		/**
+		 * Looks up `key` (with its precomputed `hash`), adding it if it isn't there yet.
+		 * @param inserted Set to whether the key was added.
+		 * @returns The index of the key.
+		 */
+		uint32_t insert(const Key& key, uint64_t hash, bool& inserted)
+		{
+			if(_keys.size() * 2 >= _slots.size())
+				rehash(std::max<size_t>(_slots.size() * 2, 16));
+
+			size_t s = hash & _mask;
+			while(_slots[s] != empty)
+			{
+				const uint32_t i = _slots[s];
+				if(_hashes[i] == hash && _equal(_keys[i], key))
+				{
+					inserted = false;
+					return i;
+				}
+				s = (s + 1) & _mask;
+			}
+
+			const uint32_t index = (uint32_t)_keys.size();
+			_slots[s] = index;
+			_keys.push_back(key);
+			_hashes.push_back(hash);
+			inserted = true;
+			return index;
+		}
+		uint32_t insert(const Key& key, bool& inserted) { return insert(key, _hash(key), inserted); }
+		uint32_t insert(const Key& key)
+		{
+			bool inserted;
+			return insert(key, _hash(key), inserted);
+		}
+	};
+
+	// Incremental 64-bit hashing for building DedupTable hashes out of several components.
+	struct HashBuilder
+	{
+		uint64_t h = 0x243F6A8885A308D3ull;
+
+		HashBuilder& add(uint64_t v)
+		{
+			h = (h ^ v) * 0x9E3779B97F4A7C15ull;
+			h ^= h >> 32;
+			return *this;
+		}
+		// Hashes the bits of `v`, with -0 treated like 0 so values comparing equal hash equally.
+		HashBuilder& add(float v) { return add((uint64_t)std::bit_cast<uint32_t>(v == 0.f ? 0.f : v)); }
+
+		// The final, fully mixed hash (splitmix64 finalizer).
+		uint64_t get() const
+		{
+			uint64_t x = h;
+			x ^= x >> 30;
+			x *= 0xBF58476D1CE4E5B9ull;
+			x ^= x >> 27;
+			x *= 0x94D049BB133111EBull;
+			x ^= x >> 31;
+			return x;
+		}
+	};
+}
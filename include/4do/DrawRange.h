@@ -0,0 +1,42 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "AABB4.h"
+
+namespace fdo
+{
+	// A consecutive run of an index buffer written by Object::tetrahedralizeCells, with the bounds of the vertex positions it uses.
+	struct DrawRange
+	{
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0; // 4 per tetrahedron
+		AABB4 bounds; // Empty if none of its tetrahedra have valid positions.
+	};
+
+	// A small cluster of tetrahedra from a single cell, for GPU-driven culling. See Tetlets.
+	struct Tetlet
+	{
+		uint32_t firstIndex = 0; // Where its tetrahedra start in the index buffer.
+		uint32_t indexCount = 0; // 4 per tetrahedron
+		uint32_t firstVertex = 0; // Where its vertices start in Tetlets::vertices.
+		uint32_t vertexCount = 0;
+		uint32_t range = 0; // The DrawRange it belongs to.
+		AABB4 bounds;
+	};
+
+	/**
+	 * Splits the tetrahedra written by Object::tetrahedralizeCells into tetlets (the tetrahedral version of meshlets)
+	 * of at most `maxVertices` vertices and `maxTetrahedra` tetrahedra. Set the limits before the call.
+	 * Tetrahedra are packed greedily in index buffer order, so spatially sorted tetrahedra (see Object::reorder)
+	 * give tighter tetlets.
+	 */
+	struct Tetlets
+	{
+		uint32_t maxVertices = 64; // 4 to 256, so local indices fit a byte.
+		uint32_t maxTetrahedra = 64;
+
+		std::vector<Tetlet> tetlets;
+		std::vector<uint32_t> vertices; // The vertices of every tetlet, as indices into the vertex buffers.
+		std::vector<uint8_t> indices; // One per index buffer entry, its vertex's position in the tetlet's part of `vertices`.
+	};
+}
@@ -33,6 +33,33 @@ namespace fdo
 		if(str == "co") return FDataType::co;
 		return FDataType::None;
 	}
+	// A set of FDataTypes, for picking which kinds of data an operation should touch.
+	enum class DataMask : uint8_t
+	{
+		None = 0,
+		v = 1 << 0, // Vertex Position
+		vn = 1 << 1, // Vertex Normal
+		vt = 1 << 2, // Vertex Texture Coordinate
+		co = 1 << 3, // Color Data (Vertex Color)
+		All = v | vn | vt | co,
+	};
+	inline constexpr DataMask operator|(DataMask a, DataMask b) { return (DataMask)((uint8_t)a | (uint8_t)b); }
+	inline constexpr DataMask operator&(DataMask a, DataMask b) { return (DataMask)((uint8_t)a & (uint8_t)b); }
+	inline constexpr DataMask operator~(DataMask a) { return (DataMask)(~(uint8_t)a & (uint8_t)DataMask::All); }
+	inline constexpr DataMask& operator|=(DataMask& a, DataMask b) { return a = a | b; }
+	inline constexpr DataMask& operator&=(DataMask& a, DataMask b) { return a = a & b; }
+	inline constexpr bool hasData(DataMask mask, FDataType type)
+	{
+		switch(type)
+		{
+		case FDataType::None: return false;
+		case FDataType::v: return (uint8_t)(mask & DataMask::v);
+		case FDataType::vn: return (uint8_t)(mask & DataMask::vn);
+		case FDataType::vt: return (uint8_t)(mask & DataMask::vt);
+		case FDataType::co: return (uint8_t)(mask & DataMask::co);
+		}
+		return false;
+	}
 	struct Format
 	{
 		std::vector<FDataType> indices{ FDataType::v };
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Point.h"
+#include "AABB4.h"
+
+namespace fdo::geometry
+{
+	/**
+	 * Intersects the line `origin + direction * t` with the tetrahedron (a 3-simplex) `a, b, c, d`.
+	 * @param t The line parameter of the intersection.
+	 * @param barycentrics The weights of `a, b, c, d` at the intersection.
+	 * @returns Whether the line crosses the tetrahedron. Lines parallel to its hyperplane never do.
+	 */
+	inline bool intersectTetrahedron(const Point& origin, const Point& direction, const Point& a, const Point& b, const Point& c, const Point& d, float& t, float (&barycentrics)[4])
+	{
+		// solve [e1 e2 e3 -dir] * (u1, u2, u3, t) = origin - a, the inverse rows are 4D cross products of the other columns
+		const Point e1 = b - a;
+		const Point e2 = c - a;
+		const Point e3 = d - a;
+		const Point nd = -direction;
+		const Point normal = Point::cross(e1, e2, e3);
+		const float det = Point::dot(normal, direction);
+		if(std::abs(det) <= 1e-20f)
+			return false;
+
+		const float invDet = 1.f / det;
+		const Point s = origin - a;
+		const float u1 = Point::dot(Point::cross(e2, e3, nd), s) * invDet;
+		const float u2 = -Point::dot(Point::cross(e1, e3, nd), s) * invDet;
+		const float u3 = Point::dot(Point::cross(e1, e2, nd), s) * invDet;
+		const float u0 = 1.f - u1 - u2 - u3;
+		if(u0 < 0.f || u1 < 0.f || u2 < 0.f || u3 < 0.f)
+			return false;
+
+		t = -Point::dot(normal, s) * invDet;
+		barycentrics[0] = u0;
+		barycentrics[1] = u1;
+		barycentrics[2] = u2;
+		barycentrics[3] = u3;
+		return true;
+	}
+
+	/**
+	 * Precomputes what's needed to intersect many lines with the tetrahedron `a, b, c, d` (or to get barycentrics of points on it).
+	 * For a point `p` on its hyperplane, the weights of `b, c, d` are `dot(dual[i], p - a)`, the one of `a` is 1 minus their sum.
+	 * @param normal The (unnormalized) normal of the hyperplane the tetrahedron lies in.
+	 * @param dual The dual basis of the edges `b - a, c - a, d - a` within that hyperplane.
+	 * @returns False if the tetrahedron is flat.
+	 */
+	inline bool tetrahedronFrame(const Point& a, const Point& b, const Point& c, const Point& d, Point& normal, Point (&dual)[3])
+	{
+		const Point e1 = b - a;
+		const Point e2 = c - a;
+		const Point e3 = d - a;
+		normal = Point::cross(e1, e2, e3);
+		if(Point::lengthSqr(normal) <= 1e-30f)
+			return false;
+
+		dual[0] = Point::cross(e2, e3, normal);
+		dual[1] = Point::cross(e1, e3, normal);
+		dual[2] = Point::cross(e1, e2, normal);
+		const float d0 = Point::dot(e1, dual[0]);
+		const float d1 = Point::dot(e2, dual[1]);
+		const float d2 = Point::dot(e3, dual[2]);
+		if(d0 == 0.f || d1 == 0.f || d2 == 0.f)
+			return false;
+		dual[0] *= 1.f / d0;
+		dual[1] *= 1.f / d1;
+		dual[2] *= 1.f / d2;
+		return true;
+	}
+
+	/**
+	 * The point on triangle `a, b, c` closest to `p`.
+	 * @param barycentrics The weights of `a, b, c` at the returned point.
+	 */
+	inline Point closestPointOnTriangle(const Point& p, const Point& a, const Point& b, const Point& c, float (&barycentrics)[3])
+	{
+		// Voronoi region tests, only using dot products so they work in any dimension
+		auto set = [&](float u, float v, float w) { barycentrics[0] = u; barycentrics[1] = v; barycentrics[2] = w; };
+
+		const Point ab = b - a;
+		const Point ac = c - a;
+		const Point ap = p - a;
+		const float d1 = Point::dot(ab, ap);
+		const float d2 = Point::dot(ac, ap);
+		if(d1 <= 0.f && d2 <= 0.f) { set(1, 0, 0); return a; }
+
+		const Point bp = p - b;
+		const float d3 = Point::dot(ab, bp);
+		const float d4 = Point::dot(ac, bp);
+		if(d3 >= 0.f && d4 <= d3) { set(0, 1, 0); return b; }
+
+		const float vc = d1 * d4 - d3 * d2;
+		if(vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+		{
+			const float v = d1 / (d1 - d3);
+			set(1 - v, v, 0);
+			return a + ab * v;
+		}
+
+		const Point cp = p - c;
+		const float d5 = Point::dot(ab, cp);
+		const float d6 = Point::dot(ac, cp);
+		if(d6 >= 0.f && d5 <= d6) { set(0, 0, 1); return c; }
+
+		const float vb = d5 * d2 - d1 * d6;
+		if(vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+		{
+			const float w = d2 / (d2 - d6);
+			set(1 - w, 0, w);
+			return a + ac * w;
+		}
+
+		const float va = d3 * d6 - d5 * d4;
+		if(va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f)
+		{
+			const float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			set(0, 1 - w, w);
+			return b + (c - b) * w;
+		}
+
+		const float denom = 1.f / (va + vb + vc);
+		const float v = vb * denom;
+		const float w = vc * denom;
+		set(1 - v - w, v, w);
+		return a + ab * v + ac * w;
+	}
+
+	/**
+	 * The point on tetrahedron `a, b, c, d` closest to `p`.
+	 * @param barycentrics The weights of `a, b, c, d` at the returned point.
+	 */
+	inline Point closestPointOnTetrahedron(const Point& p, const Point& a, const Point& b, const Point& c, const Point& d, float (&barycentrics)[4])
+	{
+		// project onto the hyperplane of the tetrahedron by solving the 3x3 normal equations
+		const Point e[3] = { b - a, c - a, d - a };
+		const Point ap = p - a;
+		float g[3][3];
+		float r[3];
+		for(int i = 0; i < 3; i++)
+		{
+			for(int j = 0; j < 3; j++)
+				g[i][j] = Point::dot(e[i], e[j]);
+			r[i] = Point::dot(e[i], ap);
+		}
+		const float det =
+			g[0][0] * (g[1][1] * g[2][2] - g[1][2] * g[2][1]) -
+			g[0][1] * (g[1][0] * g[2][2] - g[1][2] * g[2][0]) +
+			g[0][2] * (g[1][0] * g[2][1] - g[1][1] * g[2][0]);
+		if(std::abs(det) > 1e-20f)
+		{
+			const float invDet = 1.f / det;
+			const float u1 = (r[0] * (g[1][1] * g[2][2] - g[1][2] * g[2][1]) - g[0][1] * (r[1] * g[2][2] - g[1][2] * r[2]) + g[0][2] * (r[1] * g[2][1] - g[1][1] * r[2])) * invDet;
+			const float u2 = (g[0][0] * (r[1] * g[2][2] - g[1][2] * r[2]) - r[0] * (g[1][0] * g[2][2] - g[1][2] * g[2][0]) + g[0][2] * (g[1][0] * r[2] - r[1] * g[2][0])) * invDet;
+			const float u3 = (g[0][0] * (g[1][1] * r[2] - r[1] * g[2][1]) - g[0][1] * (g[1][0] * r[2] - r[1] * g[2][0]) + r[0] * (g[1][0] * g[2][1] - g[1][1] * g[2][0])) * invDet;
+			const float u0 = 1.f - u1 - u2 - u3;
+			if(u0 >= 0.f && u1 >= 0.f && u2 >= 0.f && u3 >= 0.f)
+			{
+				barycentrics[0] = u0;
+				barycentrics[1] = u1;
+				barycentrics[2] = u2;
+				barycentrics[3] = u3;
+				return a + e[0] * u1 + e[1] * u2 + e[2] * u3;
+			}
+		}
+
+		// the projection is outside (or the tetrahedron is flat), so the closest point is on one of the faces
+		const Point* v[4] = { &a, &b, &c, &d };
+		const int faces[4][3] = { { 0, 1, 2 }, { 0, 1, 3 }, { 0, 2, 3 }, { 1, 2, 3 } };
+		Point best{};
+		float bestDist = std::numeric_limits<float>::infinity();
+		for(auto& f : faces)
+		{
+			float bc[3];
+			Point q = closestPointOnTriangle(p, *v[f[0]], *v[f[1]], *v[f[2]], bc);
+			float dist = Point::lengthSqr(q - p);
+			if(dist < bestDist)
+			{
+				bestDist = dist;
+				best = q;
+				barycentrics[0] = barycentrics[1] = barycentrics[2] = barycentrics[3] = 0.f;
+				barycentrics[f[0]] = bc[0];
+				barycentrics[f[1]] = bc[1];
+				barycentrics[f[2]] = bc[2];
+			}
+		}
+		return best;
+	}
+
+	// The squared distance from `p` to the closest point of `box`. 0 if it's inside.
+	inline float distanceSqr(const AABB4& box, const Point& p)
+	{
+		const float dx = std::max({ box.min.x - p.x, 0.f, p.x - box.max.x });
+		const float dy = std::max({ box.min.y - p.y, 0.f, p.y - box.max.y });
+		const float dz = std::max({ box.min.z - p.z, 0.f, p.z - box.max.z });
+		const float dw = std::max({ box.min.w - p.w, 0.f, p.w - box.max.w });
+		return dx * dx + dy * dy + dz * dz + dw * dw;
+	}
+
+	/**
+	 * Slab test of the ray `origin + t / invDirection` against `box`, for t in [tMin, tMax].
+	 * @param tEnter The parameter where the ray enters the box.
+	 */
+	inline bool intersectAABB(const Point& origin, const Point& invDirection, const AABB4& box, float tMin, float tMax, float& tEnter)
+	{
+		const float* o = &origin.x;
+		const float* inv = &invDirection.x;
+		const float* lo = &box.min.x;
+		const float* hi = &box.max.x;
+		for(int i = 0; i < 4; i++)
+		{
+			float t0 = (lo[i] - o[i]) * inv[i];
+			float t1 = (hi[i] - o[i]) * inv[i];
+			if(t0 > t1) std::swap(t0, t1);
+			// NaN from 0 * inf (ray in a slab boundary) leaves the range unchanged
+			tMin = t0 > tMin ? t0 : tMin;
+			tMax = t1 < tMax ? t1 : tMax;
+			if(tMin > tMax)
+				return false;
+		}
+		tEnter = tMin;
+		return true;
+	}
+
+	// Half the boundary volume of a 4D box, the 4D counterpart of surface area for SAH costs.
+	inline float halfBoundary(const AABB4& box)
+	{
+		if(box.isEmpty()) return 0.f;
+		const Point s = box.max - box.min;
+		return s.x * s.y * s.z + s.x * s.y * s.w + s.x * s.z * s.w + s.y * s.z * s.w;
+	}
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Point.h"
+#include "Parallel.h"
+
+namespace fdo
+{
+	/**
+	 * A balanced 4D k-d tree over a set of points (usually `Object::vertices`), for radius and k-nearest queries.
+	 * Like SpatialHash4, it only stores point indices and takes the points on every call. Queries return indices into them.
+	 * Every node splits its range of points at the median, so the tree shape only depends on the point count
+	 * and can be stored implicitly (children of node `i` are `2i + 1` and `2i + 2`). Each level is built in parallel.
+	 */
+	class KDTree4
+	{
+	private:
+		struct Node
+		{
+			uint32_t begin = 0;
+			uint32_t end = 0;
+			float split = 0; // inner nodes: points in [begin, mid) have coordinate <= split along `axis`
+			uint8_t axis = 0;
+		};
+
+		std::vector<Node> _nodes;
+		std::vector<uint32_t> _indices; // point indices, each leaf owns a consecutive range
+		std::vector<uint32_t> _pending; // inserted since the last build, scanned linearly by queries
+		size_t _leafSize = 8;
+		size_t _depth = 0; // levels below the root, the leaves are at this depth
+		size_t _count = 0;
+
+		inline static constexpr size_t maxStack = 64;
+
+		static float axisOf(const Point& p, int axis) { return (&p.x)[axis]; }
+
+		// Calls `f(i, distanceSqr)` for every pending point.
+		template<typename F>
+		void forPending(std::span<const Point> points, const Point& center, F&& f) const
+		{
+			for(uint32_t i : _pending)
+				if(i < points.size())
+					f(i, Point::lengthSqr(points[i] - center));
+		}
+
+	public:
+		KDTree4() = default;
+		/**
+		 * @param points The points to index.
+		 * @param leafSize The most points a leaf holds.
+		 */
+		KDTree4(std::span<const Point> points, size_t leafSize = 8) { build(points, leafSize); }
+
+		// The amount of points indexed.
+		size_t size() const { return _count; }
+
+		// (Re)builds the tree over all `points`. The result doesn't depend on the thread count.
+		void build(std::span<const Point> points, size_t leafSize = 8)
+		{
+			_leafSize = std::max<size_t>(leafSize, 1);
+			_count = points.size();
+			_pending.clear();
+
+			_indices.resize(points.size());
+			for(uint32_t i = 0; i < points.size(); i++)
+				_indices[i] = i;
+
+			_depth = 0;
+			while((points.size() >> _depth) > _leafSize)
+				_depth++;
+
+			_nodes.assign(((size_t)2 << _depth) - 1, Node{});
+			_nodes[0] = { 0, (uint32_t)points.size(), 0, 0 };
+
+			for(size_t level = 0; level < _depth; level++)
+			{
+				const size_t first = ((size_t)1 << level) - 1;
+				const size_t count = (size_t)1 << level;
+				Parallel::forChunks(count, [&](size_t begin, size_t end)
+					{
+						for(size_t n = first + begin; n < first + end; n++)
+						{
+							Node& node = _nodes[n];
+
+							// split along the axis the points spread the most
+							Point lo{ std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity() };
+							Point hi = -lo;
+							for(uint32_t i = node.begin; i < node.end; i++)
+							{
+								const Point& p = points[_indices[i]];
+								lo = { std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z), std::min(lo.w, p.w) };
+								hi = { std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z), std::max(hi.w, p.w) };
+							}
+							const Point extent = hi - lo;
+							int axis = 0;
+							for(int a = 1; a < 4; a++)
+								if(axisOf(extent, a) > axisOf(extent, axis)) axis = a;
+
+							const uint32_t mid = node.begin + (node.end - node.begin) / 2;
+							if(node.end > node.begin)
+								std::nth_element(_indices.begin() + node.begin, _indices.begin() + mid, _indices.begin() + node.end,
+									[&](uint32_t a, uint32_t b)
+									{
+										float ca = axisOf(points[a], axis);
+										float cb = axisOf(points[b], axis);
+										return ca < cb || (ca == cb && a < b);
+									});
+
+							node.axis = (uint8_t)axis;
+							node.split = node.end > node.begin ? axisOf(points[_indices[mid]], axis) : 0.f;
+							_nodes[2 * n + 1] = { node.begin, mid, 0, 0 };
+							_nodes[2 * n + 2] = { mid, node.end, 0, 0 };
+						}
+					}, std::max<size_t>(1, Parallel::getChunkSize() / std::max<size_t>(1, points.size() >> level)));
+			}
+		}
+
+		/**
+		 * Indexes the points added to the end of `points` since the last `build` or `insert`
+		 * (e.g. after `Object::pushVertex`). Cheap per call; rebuilds the tree once enough points piled up.
+		 */
+		void insert(std::span<const Point> points)
+		{
+			for(size_t i = _count; i < points.size(); i++)
+				_pending.push_back((uint32_t)i);
+			_count = std::max(_count, points.size());
+			if(_pending.size() > 1024 && _pending.size() * 8 > _indices.size())
+				build(points, _leafSize);
+		}
+
+		/**
+		 * Finds the points within `radius` of `center`.
+		 * @param out The point indices, in ascending order. Gets cleared first.
+		 */
+		void radius(std::span<const Point> points, const Point& center, float radius, std::vector<uint32_t>& out) const
+		{
+			out.clear();
+			const float rSqr = radius * radius;
+
+			if(!_nodes.empty() && radius >= 0.f)
+			{
+				size_t stack[maxStack];
+				size_t top = 0;
+				stack[top++] = 0;
+				while(top > 0)
+				{
+					const size_t n = stack[--top];
+					const Node& node = _nodes[n];
+					if(2 * n + 1 >= _nodes.size())
+					{
+						for(uint32_t i = node.begin; i < node.end; i++)
+							if(_indices[i] < points.size() && Point::lengthSqr(points[_indices[i]] - center) <= rSqr)
+								out.push_back(_indices[i]);
+						continue;
+					}
+					const float d = axisOf(center, node.axis) - node.split;
+					if(d <= radius) stack[top++] = 2 * n + 1;
+					if(d >= -radius) stack[top++] = 2 * n + 2;
+				}
+			}
+			forPending(points, center, [&](uint32_t i, float d) { if(d <= rSqr) out.push_back(i); });
+
+			std::sort(out.begin(), out.end());
+		}
+
+		/**
+		 * Finds the `k` points closest to `center`.
+		 * @param out The point indices, closest first (ties go to the lower index). Gets cleared first.
+		 * @param maxDistance Points further away than this are ignored.
+		 */
+		void nearest(std::span<const Point> points, const Point& center, size_t k, std::vector<uint32_t>& out, float maxDistance = std::numeric_limits<float>::infinity()) const
+		{
+			out.clear();
+			if(k == 0)
+				return;
+
+			// max-heap of the best candidates so far, ordered by (distance, index)
+			std::vector<std::pair<float, uint32_t>> heap;
+			heap.reserve(k + 1);
+			float bound = maxDistance < std::numeric_limits<float>::infinity() ? maxDistance * maxDistance : maxDistance;
+			auto consider = [&](uint32_t i, float d)
+				{
+					if(d > bound)
+						return;
+					std::pair<float, uint32_t> c{ d, i };
+					if(heap.size() == k && !(c < heap.front()))
+						return;
+					heap.push_back(c);
+					std::push_heap(heap.begin(), heap.end());
+					if(heap.size() > k)
+					{
+						std::pop_heap(heap.begin(), heap.end());
+						heap.pop_back();
+					}
+					if(heap.size() == k)
+						bound = heap.front().first;
+				};
+
+			forPending(points, center, consider);
+
+			if(!_nodes.empty())
+			{
+				// (node, squared distance to its half-space) pairs
+				std::pair<size_t, float> stack[maxStack];
+				size_t top = 0;
+				stack[top++] = { 0, 0.f };
+				while(top > 0)
+				{
+					const auto [n, nodeDist] = stack[--top];
+					if(nodeDist > bound)
+						continue;
+					const Node& node = _nodes[n];
+					if(2 * n + 1 >= _nodes.size())
+					{
+						for(uint32_t i = node.begin; i < node.end; i++)
+							if(_indices[i] < points.size())
+								consider(_indices[i], Point::lengthSqr(points[_indices[i]] - center));
+						continue;
+					}
+					// visit the side the center is on first
+					const float d = axisOf(center, node.axis) - node.split;
+					const size_t nearChild = d <= 0.f ? 2 * n + 1 : 2 * n + 2;
+					const size_t farChild = d <= 0.f ? 2 * n + 2 : 2 * n + 1;
+					stack[top++] = { farChild, std::max(nodeDist, d * d) };
+					stack[top++] = { nearChild, nodeDist };
+				}
+			}
+
+			std::sort_heap(heap.begin(), heap.end());
+			for(auto& c : heap)
+				out.push_back(c.second);
+		}
+
+		/**
+		 * Finds the point closest to `center`.
+		 * @returns The point index, or -1 if there's none within `maxDistance`.
+		 */
+		int32_t nearest(std::span<const Point> points, const Point& center, float maxDistance = std::numeric_limits<float>::infinity()) const
+		{
+			std::vector<uint32_t> out;
+			nearest(points, center, 1, out, maxDistance);
+			return out.empty() ? -1 : (int32_t)out[0];
+		}
+	};
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Point.h"
+
+namespace fdo
+{
+	// The planes 4D rotations happen in.
+	enum class RotationPlane : uint8_t
+	{
+		XY,
+		XZ,
+		XW,
+		YZ,
+		YW,
+		ZW,
+	};
+
+	/**
+	 * A 4D affine transformation matrix.
+	 * Stored as 5 columns: 4 for the linear part and 1 for the translation.
+	 * The last row is implicitly (0 0 0 0 1), so only affine transformations can be represented.
+	 */
+	struct Mat5
+	{
+		std::array<Point, 5> columns
+		{
+			Point{ 1, 0, 0, 0 },
+			Point{ 0, 1, 0, 0 },
+			Point{ 0, 0, 1, 0 },
+			Point{ 0, 0, 0, 1 },
+			Point{ 0, 0, 0, 0 },
+		};
+
+		constexpr Point& operator[](size_t i)
+		{
+			if(i >= 5)
+				throw std::out_of_range("fdo::Mat5::operator[]: Index out of range.");
+			return columns[i];
+		}
+		constexpr const Point& operator[](size_t i) const
+		{
+			if(i >= 5)
+				throw std::out_of_range("fdo::Mat5::operator[]: Index out of range.");
+			return columns[i];
+		}
+
+		// Returns the element at `row`, `col`. Row 4 is the implicit (0 0 0 0 1) row.
+		float at(size_t row, size_t col) const
+		{
+			if(row == 4)
+				return col == 4 ? 1.f : 0.f;
+			return columns.at(col)[row];
+		}
+
+		bool operator==(const Mat5& other) const { return columns == other.columns; }
+
+		// Transforms a point (applies the translation).
+		Point operator*(const Point& p) const
+		{
+			return columns[0] * p.x + columns[1] * p.y + columns[2] * p.z + columns[3] * p.w + columns[4];
+		}
+		// Transforms a direction (ignores the translation).
+		Point transformDirection(const Point& d) const
+		{
+			return columns[0] * d.x + columns[1] * d.y + columns[2] * d.z + columns[3] * d.w;
+		}
+
+		// Composition. (a * b) * p == a * (b * p)
+		Mat5 operator*(const Mat5& other) const
+		{
+			Mat5 result{};
+			for(size_t i = 0; i < 4; i++)
+				result.columns[i] = transformDirection(other.columns[i]);
+			result.columns[4] = *this * other.columns[4];
+			return result;
+		}
+		Mat5& operator*=(const Mat5& other)
+		{
+			*this = *this * other;
+			return *this;
+		}
+
+		/**
+		 * Fills the linear part (column-major 4x4) and the translation, in the layout the SIMD kernels expect.
+		 */
+		void toArrays(float (&linear)[16], float (&translation)[4]) const
+		{
+			for(size_t c = 0; c < 4; c++)
+				for(size_t r = 0; r < 4; r++)
+					linear[c * 4 + r] = columns[c][r];
+			for(size_t r = 0; r < 4; r++)
+				translation[r] = columns[4][r];
+		}
+
+		/**
+		 * @returns The determinant of the linear part.
+		 */
+		float determinant() const
+		{
+			const Point& a = columns[0];
+			// the 4D cross product of the other 3 columns is orthogonal to them, so dot-ing with it expands along the first column
+			return Point::dot(a, Point::cross(columns[1], columns[2], columns[3]));
+		}
+
+		/**
+		 * @returns The transpose of the linear part. The translation is dropped.
+		 */
+		Mat5 transposedLinear() const
+		{
+			Mat5 result{};
+			for(size_t c = 0; c < 4; c++)
+				for(size_t r = 0; r < 4; r++)
+					result.columns[c][r] = columns[r][c];
+			result.columns[4] = { 0, 0, 0, 0 };
+			return result;
+		}
+
+		/**
+		 * @returns The inverse transformation. Returns the identity if the matrix isn't invertible.
+		 */
+		Mat5 inverse() const
+		{
+			// The rows of the inverse of a 4x4 matrix are the 4D cross products of the other 3 columns, divided by the determinant.
+			const Point& c0 = columns[0];
+			const Point& c1 = columns[1];
+			const Point& c2 = columns[2];
+			const Point& c3 = columns[3];
+
+			Point r0 = Point::cross(c1, c2, c3);
+			float det = Point::dot(c0, r0);
+			if(std::abs(det) <= 1e-20f)
+				return Mat5{};
+
+			Point r1 = -Point::cross(c0, c2, c3);
+			Point r2 = Point::cross(c0, c1, c3);
+			Point r3 = -Point::cross(c0, c1, c2);
+
+			float invDet = 1.f / det;
+			Mat5 rows{};
+			rows.columns = { r0 * invDet, r1 * invDet, r2 * invDet, r3 * invDet, Point{ 0, 0, 0, 0 } };
+
+			// `rows` holds the inverse transposed
+			Mat5 result = rows.transposedLinear();
+			result.columns[4] = -result.transformDirection(columns[4]);
+			return result;
+		}
+
+		/**
+		 * @returns The matrix for transforming normals (inverse transpose of the linear part).
+		 */
+		Mat5 normalMatrix() const
+		{
+			return inverse().transposedLinear();
+		}
+
+		/**
+		 * @param epsilon The tolerance.
+		 * @returns `true` if the linear part is a rotation/reflection (keeps lengths and angles).
+		 */
+		bool isOrthonormal(float epsilon = 1e-5f) const
+		{
+			for(size_t i = 0; i < 4; i++)
+				for(size_t j = 0; j < 4; j++)
+					if(std::abs(Point::dot(columns[i], columns[j]) - (i == j ? 1.f : 0.f)) > epsilon)
+						return false;
+			return true;
+		}
+
+		std::string toString() const
+		{
+			std::string result;
+			for(size_t r = 0; r < 5; r++)
+				result += std::format("{} {} {} {} {}\n", at(r, 0), at(r, 1), at(r, 2), at(r, 3), at(r, 4));
+			result.erase(result.size() - 1, 1);
+			return result;
+		}
+
+		inline static Mat5 identity() { return Mat5{}; }
+
+		inline static Mat5 translation(const Point& v)
+		{
+			Mat5 result{};
+			result.columns[4] = v;
+			return result;
+		}
+
+		inline static Mat5 scale(const Point& v)
+		{
+			Mat5 result{};
+			for(size_t i = 0; i < 4; i++)
+				result.columns[i][i] = v[i];
+			return result;
+		}
+
+		/**
+		 * @param plane The plane of rotation.
+		 * @param angle The angle in radians. Rotates the first axis of the plane towards the second.
+		 */
+		inline static Mat5 rotation(RotationPlane plane, float angle)
+		{
+			size_t a = 0, b = 1;
+			switch(plane)
+			{
+			case RotationPlane::XY: a = 0; b = 1; break;
+			case RotationPlane::XZ: a = 0; b = 2; break;
+			case RotationPlane::XW: a = 0; b = 3; break;
+			case RotationPlane::YZ: a = 1; b = 2; break;
+			case RotationPlane::YW: a = 1; b = 3; break;
+			case RotationPlane::ZW: a = 2; b = 3; break;
+			}
+
+			float c = cosf(angle);
+			float s = sinf(angle);
+
+			Mat5 result{};
+			result.columns[a][a] = c;
+			result.columns[a][b] = s;
+			result.columns[b][a] = -s;
+			result.columns[b][b] = c;
+			return result;
+		}
+		inline static Mat5 rotationXY(float angle) { return rotation(RotationPlane::XY, angle); }
+		inline static Mat5 rotationXZ(float angle) { return rotation(RotationPlane::XZ, angle); }
+		inline static Mat5 rotationXW(float angle) { return rotation(RotationPlane::XW, angle); }
+		inline static Mat5 rotationYZ(float angle) { return rotation(RotationPlane::YZ, angle); }
+		inline static Mat5 rotationYW(float angle) { return rotation(RotationPlane::YW, angle); }
+		inline static Mat5 rotationZW(float angle) { return rotation(RotationPlane::ZW, angle); }
+
+		/**
+		 * Combines rotations in all 6 planes, applied in the order XY, XZ, XW, YZ, YW, ZW.
+		 * @param xy,xz,xw,yz,yw,zw The angles in radians.
+		 */
+		inline static Mat5 rotation(float xy, float xz, float xw, float yz, float yw, float zw)
+		{
+			return rotationZW(zw) * rotationYW(yw) * rotationYZ(yz) * rotationXW(xw) * rotationXZ(xz) * rotationXY(xy);
+		}
+	};
+
+	// additional names
+
+	typedef Mat5 mat5;
+}
+
+namespace std
+{
+	inline ostream& operator<<(ostream& os, const fdo::Mat5& m)
+	{
+		return os << m.toString();
+	}
+	inline string to_string(const fdo::Mat5& m) noexcept
+	{
+		return m.toString();
+	}
+}
@@ -2,6 +2,18 @@
 
 #include "basicIncludes.h"
 #include "Point.h"
+#include "Mat5.h"
+#include "AABB4.h"
+#include "CellBounds.h"
+#include "CrossSection.h"
+#include "SliceIndex.h"
+#include "ProjectionMode.h"
+#include "Curve.h"
+#include "Dedup.h"
+#include "VertexLayout.h"
+#include "DrawRange.h"
+#include "TetrahedralizeScratch.h"
+#include "TetrahedralizeContext.h"
 #include "Orientation.h"
 #include "TexCoord.h"
 
@@ -10,6 +22,11 @@
 #include "Cell.h"
 #include "Color.h"
 #include "Format.h"
+#include "SharedBuffer.h"
+#include "DedupTable.h"
+#include "SpatialHash4.h"
+#include "SIMD.h"
+#include "Parallel.h"
 
 #include "Logger.h"
 
@@ -20,22 +37,438 @@ namespace fdo
 	private:
 		bool _invalid = false;
 
+		// Results of the last fused bounds/center pass over the vertices. Stale once `vertices.version()` changes.
+		struct BoundsCache
+		{
+			mutable std::mutex mutex;
+			bool valid = false;
+			uint64_t version = 0;
+			AABB4 bounds{};
+			Point center{0,0,0,0};
+
+			BoundsCache() = default;
+			BoundsCache(const BoundsCache& other) { *this = other; }
+			BoundsCache& operator=(const BoundsCache& other)
+			{
+				if(this == &other) return *this;
+				std::scoped_lock lock(mutex, other.mutex);
+				valid = other.valid;
+				version = other.version;
+				bounds = other.bounds;
+				center = other.center;
+				return *this;
+			}
+		};
+		mutable BoundsCache _boundsCache;
+
+		// Returns the cache, recomputing it first if the vertices changed since. Expects `_boundsCache.mutex` to be locked.
+		const BoundsCache& updateBoundsCache() const
+		{
+			if(_boundsCache.valid && _boundsCache.version == vertices.version())
+				return _boundsCache;
+
+			struct Partial
+			{
+				AABB4 bounds{};
+				Point sum{0,0,0,0};
+			};
+
+			const float* data = reinterpret_cast<const float*>(vertices.get().data());
+
+			// min, max and sum in one pass per chunk, then combined in chunk order so the result doesn't depend on the thread count
+			Partial total = Parallel::reduceChunks(vertices.size(), Partial{},
+				[&](size_t begin, size_t end)
+				{
+					constexpr float inf = std::numeric_limits<float>::infinity();
+					float mn[4] = { inf, inf, inf, inf };
+					float mx[4] = { -inf, -inf, -inf, -inf };
+					float sum[4] = { 0, 0, 0, 0 };
+					simd::boundsSum4(data + begin * 4, end - begin, mn, mx, sum);
+
+					Partial p{};
+					p.bounds.min = { mn[0], mn[1], mn[2], mn[3] };
+					p.bounds.max = { mx[0], mx[1], mx[2], mx[3] };
+					p.sum = { sum[0], sum[1], sum[2], sum[3] };
+					return p;
+				},
+				[](Partial a, const Partial& b)
+				{
+					a.bounds.expand(b.bounds);
+					a.sum += b.sum;
+					return a;
+				});
+
+			_boundsCache.bounds = total.bounds;
+			_boundsCache.center = vertices.empty() ? Point{0,0,0,0} : total.sum / (float)vertices.size();
+			_boundsCache.version = vertices.version();
+			_boundsCache.valid = true;
+
+			return _boundsCache;
+		}
+
+		// Per-cell bounds from the last pass over the cells. Stale once the vertices, tetrahedra or cells change.
+		struct CellBoundsCache
+		{
+			mutable std::mutex mutex;
+			bool valid = false;
+			uint64_t verticesVersion = 0;
+			uint64_t tetrahedraVersion = 0;
+			uint64_t cellsVersion = 0;
+			std::vector<CellBounds> bounds;
+
+			CellBoundsCache() = default;
+			CellBoundsCache(const CellBoundsCache& other) { *this = other; }
+			CellBoundsCache& operator=(const CellBoundsCache& other)
+			{
+				if(this == &other) return *this;
+				std::scoped_lock lock(mutex, other.mutex);
+				valid = other.valid;
+				verticesVersion = other.verticesVersion;
+				tetrahedraVersion = other.tetrahedraVersion;
+				cellsVersion = other.cellsVersion;
+				bounds = other.bounds;
+				return *this;
+			}
+
+			bool isCurrent(const Object& obj) const
+			{
+				return valid && verticesVersion == obj.vertices.version() && tetrahedraVersion == obj.tetrahedra.version() && cellsVersion == obj.cells.version();
+			}
+		};
+		mutable CellBoundsCache _cellBoundsCache;
+
+		// Returns the cell bounds, recomputing them first if anything changed since. Expects `_cellBoundsCache.mutex` to be locked.
+		const std::vector<CellBounds>& updateCellBoundsCache() const
+		{
+			CellBoundsCache& cache = _cellBoundsCache;
+			if(cache.isCurrent(*this))
+				return cache.bounds;
+
+			const std::vector<Cell>& cellList = cells.get();
+			const std::vector<Tetrahedron>& tets = tetrahedra.get();
+			const std::vector<Point>& verts = vertices.get();
+			cache.bounds.resize(cellList.size());
+
+			// box first, then the sphere around the box center. Cells are independent, so chunking doesn't change the result
+			Parallel::forChunks(cellList.size(), [&](size_t begin, size_t end)
+				{
+					auto forVertices = [&](const Cell& cell, auto&& f)
+						{
+							for(int32_t t : cell.tIndices)
+								if(t >= 0 && (size_t)t < tets.size())
+									for(int k = 0; k < 4; k++)
+									{
+										const int32_t v = tets[t].vIndices[k];
+										if(v >= 0 && (size_t)v < verts.size())
+											f(verts[v]);
+									}
+						};
+					for(size_t c = begin; c < end; c++)
+					{
+						CellBounds b;
+						forVertices(cellList[c], [&](const Point& p) { b.box.expand(p); });
+						if(!b.box.isEmpty())
+						{
+							b.center = b.box.getCenter();
+							float radiusSqr = 0.f;
+							forVertices(cellList[c], [&](const Point& p) { radiusSqr = std::max(radiusSqr, Point::lengthSqr(p - b.center)); });
+							// a hair bigger, so vertices right on the sphere don't get culled by rounding
+							b.radius = std::sqrt(radiusSqr) * (1.f + 1e-5f);
+						}
+						cache.bounds[c] = b;
+					}
+				}, std::max<size_t>(Parallel::getChunkSize() / 256, 1));
+
+			cache.verticesVersion = vertices.version();
+			cache.tetrahedraVersion = tetrahedra.version();
+			cache.cellsVersion = cells.version();
+			cache.valid = true;
+			return cache.bounds;
+		}
+
+		/**
+		 * Moves up-to-date cell bounds along with a transform of the vertices that maps them exactly (translations and uniform scales),
+		 * so they don't have to be recomputed. `transform` runs in between and changes the vertices.
+		 */
+		template<typename T, typename F>
+		void keepCellBounds(T&& transform, F&& moveBounds)
+		{
+			std::lock_guard lock(_cellBoundsCache.mutex);
+			const bool current = _cellBoundsCache.isCurrent(*this);
+			transform();
+			if(!current)
+				return;
+			Parallel::forChunks(_cellBoundsCache.bounds.size(), [&](size_t begin, size_t end)
+				{
+					for(size_t c = begin; c < end; c++)
+						if(!_cellBoundsCache.bounds[c].isEmpty())
+							moveBounds(_cellBoundsCache.bounds[c]);
+				});
+			_cellBoundsCache.verticesVersion = vertices.version();
+		}
+
+		// Runs a SIMD kernel `kernel(float* data, size_t count)` over the whole buffer, split into chunks across threads.
+		template<typename K>
+		static void runKernel(SharedBuffer<Point>& buffer, K&& kernel)
+		{
+			if(buffer.empty()) return;
+
+			float* data = reinterpret_cast<float*>(buffer.mutate().data());
+			Parallel::forChunks(buffer.size(), [&](size_t begin, size_t end) { kernel(data + begin * 4, end - begin); });
+		}
+
+		// Replaces every element with `f(element)`, split into chunks across threads with Execution::Parallel.
+		template<typename T, typename F>
+		static void forEachElement(SharedBuffer<T>& buffer, F& f, Execution execution)
+		{
+			if(buffer.empty()) return;
+
+			std::vector<T>& data = buffer.mutate();
+			auto run = [&](size_t begin, size_t end)
+				{
+					for(size_t i = begin; i < end; i++)
+						data[i] = f(data[i]);
+				};
+			if(execution == Execution::Parallel)
+				Parallel::forChunks(data.size(), run);
+			else
+				run(0, data.size());
+		}
+
+		// Calls `f` with consecutive spans of at most `batchSize` elements, on several threads at once with Execution::Parallel.
+		template<typename T, typename F>
+		static void forEachBatch(SharedBuffer<T>& buffer, F& f, size_t batchSize, Execution execution)
+		{
+			if(buffer.empty()) return;
+			if(batchSize == 0) batchSize = buffer.size();
+
+			std::vector<T>& data = buffer.mutate();
+			if(execution == Execution::Parallel)
+				Parallel::forChunks(data.size(), [&](size_t begin, size_t end)
+					{
+						f(std::span<T>(data.data() + begin, end - begin));
+					}, batchSize);
+			else
+				for(size_t begin = 0; begin < data.size(); begin += batchSize)
+					f(std::span<T>(data.data() + begin, std::min(batchSize, data.size() - begin)));
+		}
+
+		// Appends copies of `src` to `dst`, with `rebase` applied to each of them, split into chunks across threads.
+		template<typename T, typename F>
+		static void appendRebased(SharedBuffer<T>& dst, const SharedBuffer<T>& src, F&& rebase)
+		{
+			if(src.empty()) return;
+
+			const std::vector<T>& in = src.get();
+			std::vector<T>& out = dst.mutate();
+			size_t start = out.size();
+			out.resize(start + in.size());
+
+			Parallel::forChunks(in.size(), [&](size_t begin, size_t end)
+				{
+					for(size_t i = begin; i < end; i++)
+					{
+						T& e = out[start + i];
+						e = in[i];
+						rebase(e);
+					}
+				});
+		}
+
+		// Offsets every valid (non-negative) index.
+		template<typename C>
+		static void rebaseIndices(C& indices, size_t offset)
+		{
+			for(auto& ind : indices)
+				if(ind >= 0)
+					ind += (int32_t)offset;
+		}
+
+		// Replaces every valid index `i` with `map[i]`. Indices outside the map are left alone.
+		template<typename C>
+		static void remapIndices(C& indices, const std::vector<int32_t>& map)
+		{
+			for(auto& ind : indices)
+				if(ind >= 0 && ind < (int32_t)map.size())
+					ind = map[ind];
+		}
+
+		/**
+		 * Remaps the attribute indices of every tetrahedron and polyline, split into chunks across threads.
+		 * An empty map leaves that attribute type alone. Maps can contain -1 for removed elements.
+		 */
+		void remapAttributeIndices(const std::vector<int32_t>& v, const std::vector<int32_t>& vn, const std::vector<int32_t>& vt, const std::vector<int32_t>& co)
+		{
+			if(v.empty() && vn.empty() && vt.empty() && co.empty()) return;
+
+			auto remap = [&](auto& e)
+				{
+					if(!v.empty()) remapIndices(e.vIndices, v);
+					if(!vn.empty()) remapIndices(e.vnIndices, vn);
+					if(!vt.empty()) remapIndices(e.vtIndices, vt);
+					if(!co.empty()) remapIndices(e.coIndices, co);
+				};
+			auto remapAll = [&](auto& buffer)
+				{
+					if(buffer.empty()) return;
+					auto& data = buffer.mutate();
+					Parallel::forChunks(data.size(), [&](size_t begin, size_t end)
+						{
+							for(size_t i = begin; i < end; i++)
+								remap(data[i]);
+						});
+				};
+			remapAll(tetrahedra);
+			remapAll(polylines);
+		}
+
+		/**
+		 * Merges the elements of `buffer` lying within `epsilon` of each other (as given by `toPoint`), keeping the first of each group.
+		 * @returns The old-to-new index map, or an empty one if nothing got merged.
+		 */
+		template<typename T, typename F>
+		static std::vector<int32_t> weldBuffer(SharedBuffer<T>& buffer, float epsilon, F&& toPoint)
+		{
+			const std::vector<T>& in = buffer.get();
+			if(in.size() < 2) return {};
+
+			std::vector<Point> points(in.size());
+			Parallel::forChunks(in.size(), [&](size_t begin, size_t end)
+				{
+					for(size_t i = begin; i < end; i++)
+						points[i] = toPoint(in[i]);
+				});
+
+			const float radius = std::max(epsilon, 0.f);
+			SpatialHash4 hash(points, radius > 0.f ? radius : 1.f);
+
+			// greedy in index order: every element not merged yet starts a group and pulls in its unmerged neighbours
+			std::vector<int32_t> map(in.size(), -1);
+			std::vector<T> out;
+			std::vector<uint32_t> near;
+			std::vector<uint32_t> buckets;
+			for(size_t i = 0; i < in.size(); i++)
+			{
+				if(map[i] >= 0) continue;
+				map[i] = (int32_t)out.size();
+				out.push_back(in[i]);
+				hash.radius(points, points[i], radius, near, buckets);
+				for(uint32_t j : near)
+					if(j > i && map[j] < 0)
+						map[j] = map[i];
+			}
+
+			if(out.size() == in.size()) return {};
+			buffer = std::move(out);
+			return map;
+		}
+
+		/**
+		 * Drops the elements of `buffer` whose mark is 0 and releases the excess capacity, unless the data is shared
+		 * (shrinking would copy it).
+		 * New indices are prefix sums of the marks, computed per chunk in parallel.
+		 * @returns The old-to-new index map (-1 for dropped elements), or an empty one if nothing got dropped.
+		 */
+		template<typename T>
+		static std::vector<int32_t> compactBuffer(SharedBuffer<T>& buffer, const std::vector<uint8_t>& marks)
+		{
+			const std::vector<T>& in = buffer.get();
+			const size_t chunk = Parallel::getChunkSize();
+			const size_t chunks = (in.size() + chunk - 1) / chunk;
+
+			std::vector<size_t> offsets(chunks + 1, 0);
+			Parallel::forChunks(in.size(), [&](size_t begin, size_t end)
+				{
+					size_t count = 0;
+					for(size_t i = begin; i < end; i++)
+						count += marks[i];
+					offsets[begin / chunk + 1] = count;
+				}, chunk);
+			for(size_t i = 1; i <= chunks; i++)
+				offsets[i] += offsets[i - 1];
+
+			if(offsets[chunks] == in.size())
+			{
+				if(buffer.capacity() > buffer.size() && !buffer.isShared())
+					buffer.shrink_to_fit();
+				return {};
+			}
+
+			std::vector<int32_t> map(in.size());
+			std::vector<T> out(offsets[chunks]);
+			Parallel::forChunks(in.size(), [&](size_t begin, size_t end)
+				{
+					size_t next = offsets[begin / chunk];
+					for(size_t i = begin; i < end; i++)
+					{
+						if(!marks[i])
+						{
+							map[i] = -1;
+							continue;
+						}
+						out[next] = in[i];
+						map[i] = (int32_t)next++;
+					}
+				}, chunk);
+
+			buffer = std::move(out);
+			return map;
+		}
+
+		// Heap memory held by a buffer, including the index vectors inside polylines and cells.
+		template<typename T>
+		static size_t bufferMemory(const SharedBuffer<T>& buffer)
+		{
+			size_t bytes = buffer.capacity() * sizeof(T);
+			if constexpr(std::is_same_v<T, Polyline>)
+				for(const Polyline& p : buffer.get())
+					bytes += (p.vIndices.capacity() + p.vnIndices.capacity() + p.vtIndices.capacity() + p.coIndices.capacity()) * sizeof(int32_t);
+			else if constexpr(std::is_same_v<T, Cell>)
+				for(const Cell& c : buffer.get())
+					bytes += c.tIndices.capacity() * sizeof(int32_t);
+			return bytes;
+		}
+
+		// The position of `p` along `curve`, on a 65536^4 grid spanning `bounds`.
+		static uint64_t curveKeyOf(Curve curve, const AABB4& bounds, const Point& p)
+		{
+			const float* lo = &bounds.min.x;
+			const float* hi = &bounds.max.x;
+			const float* v = &p.x;
+			uint32_t cell[4];
+			for(int i = 0; i < 4; i++)
+			{
+				const float size = hi[i] - lo[i];
+				const float t = size > 0.f ? (v[i] - lo[i]) / size : 0.f;
+				cell[i] = (uint32_t)std::clamp(t * 65535.f, 0.f, 65535.f);
+			}
+			return curveKey(curve, cell);
+		}
+
 	public:
 		uint8_t specVer = 1; // Specification Version
 		Orientation orientation{X, Y, Z, W}; // Orientation
 
-		std::vector<Point> vertices; // Vertices
-		std::vector<Point> normals; // Normals
-		std::vector<TexCoord> texCoords; // Texture coordinates
-		std::vector<Color> colors; // Colors
+		// All of the data arrays are copy-on-write, so copying an Object is cheap
+		// and the data only gets duplicated once one of the copies writes to it.
+		// Reading elements never copies, writing them goes through `mutate()`, e.g. `obj.vertices.mutate()[i] = p;`
+		// (see SharedBuffer for how references from `mutate()` behave across copies).
+
+		SharedBuffer<Point> vertices; // Vertices
+		SharedBuffer<Point> normals; // Normals
+		SharedBuffer<TexCoord> texCoords; // Texture coordinates
+		SharedBuffer<Color> colors; // Colors
 
-		std::vector<Tetrahedron> tetrahedra; // Tetrahedra
-		std::vector<Polyline> polylines; // Polylines
-		std::vector<Cell> cells; // Cells
+		SharedBuffer<Tetrahedron> tetrahedra; // Tetrahedra
+		SharedBuffer<Polyline> polylines; // Polylines
+		SharedBuffer<Cell> cells; // Cells
 
 		Format tformat{};
 		Format pformat{};
 
+		// The default amount of elements handed to the batched transform callables at once.
+		inline static constexpr size_t defaultBatchSize = 4096;
+
 		Object(uint8_t specVer = 1) : specVer(specVer) {}
 
 		bool isInvalid() const { return _invalid; }
@@ -688,10 +1121,11 @@ namespace fdo
 		 */
 		Object& orient(const Orientation& newOrientation)
 		{
-			for(auto& v : vertices)
-				v = Orientation::transform(v, orientation, newOrientation);
-			for (auto& n : normals)
-				n = Orientation::transform(n, orientation, newOrientation);
+			float m[16];
+			Orientation::transformMatrix(orientation, newOrientation, m);
+
+			runKernel(vertices, [&](float* data, size_t count) { simd::transform4(data, count, m, { 0, 0, 0, 0 }); });
+			runKernel(normals, [&](float* data, size_t count) { simd::transform4(data, count, m, { 0, 0, 0, 0 }); });
 
 			orientation = newOrientation;
 
@@ -1080,80 +1514,332 @@ namespace fdo
 		 */
 		Object& combineWith(const Object& other)
 		{
+			// appending to itself would read from the data while it's being resized
+			if(&other == this)
+				return combineWith(Object{other});
+
 			size_t startV = vertices.size();
 			size_t startVN = normals.size();
 			size_t startVT = texCoords.size();
 			size_t startCO = colors.size();
 
-			vertices.insert(vertices.end(), other.vertices.begin(), other.vertices.end());
-			normals.insert(normals.end(), other.normals.begin(), other.normals.end());
-			texCoords.insert(texCoords.end(), other.texCoords.begin(), other.texCoords.end());
-			colors.insert(colors.end(), other.colors.begin(), other.colors.end());
+			// when there's nothing to append to, just share the other Object's data instead of copying it
+			auto append = [](auto& dst, const auto& src)
+				{
+					if(dst.empty())
+						dst = src;
+					else if(!src.empty())
+						dst.insert(dst.end(), src.begin(), src.end());
+				};
+
+			append(vertices, other.vertices);
+			append(normals, other.normals);
+			append(texCoords, other.texCoords);
+			append(colors, other.colors);
 
 			size_t startT = tetrahedra.size();
 
-			for(auto& tet : other.tetrahedra)
+			// no offsets means the indices can be shared as-is too
+			if(startV == 0 && startVN == 0 && startVT == 0 && startCO == 0)
+			{
+				append(tetrahedra, other.tetrahedra);
+				append(polylines, other.polylines);
+			}
+			else
 			{
-				Tetrahedron newTet{tet};
+				appendRebased(tetrahedra, other.tetrahedra, [&](Tetrahedron& tet)
+					{
+						rebaseIndices(tet.vIndices, startV);
+						rebaseIndices(tet.vnIndices, startVN);
+						rebaseIndices(tet.vtIndices, startVT);
+						rebaseIndices(tet.coIndices, startCO);
+					});
+				appendRebased(polylines, other.polylines, [&](Polyline& pl)
+					{
+						rebaseIndices(pl.vIndices, startV);
+						rebaseIndices(pl.vnIndices, startVN);
+						rebaseIndices(pl.vtIndices, startVT);
+						rebaseIndices(pl.coIndices, startCO);
+					});
+			}
+			if(startT == 0)
+				append(cells, other.cells);
+			else
+				appendRebased(cells, other.cells, [&](Cell& c) { rebaseIndices(c.tIndices, startT); });
 
-				for(auto& ind : newTet.vIndices)
-					ind += startV;
-				for(auto& ind : newTet.vnIndices)
-					ind += startVN;
-				for(auto& ind : newTet.vtIndices)
-					ind += startVT;
-				for(auto& ind : newTet.coIndices)
-					ind += startCO;
+			return *this;
+		}
 
-				tetrahedra.emplace_back(newTet);
-			}
-			for(auto& pl : other.polylines)
+		/**
+		 * Merges vertices, normals, texture coordinates and colors lying within `epsilon` of each other, and rewrites
+		 * the tetrahedron and polyline indices to match. Of every group of close elements, the one with the lowest index
+		 * is kept; elements are only merged with it directly (within `epsilon` of it, not through a chain of neighbours).
+		 * Runs in about linear time using a SpatialHash4.
+		 * @param epsilon The merge distance. Colors are compared as RGBA in the 0-1 range. 0 only merges identical elements.
+		 * @param mask Which attribute types to weld.
+		 * @return *this (for chaining)
+		 */
+		Object& weld(float epsilon, DataMask mask = DataMask::All)
+		{
+			std::vector<int32_t> v, vn, vt, co;
+			if(hasData(mask, FDataType::v))
+				v = weldBuffer(vertices, epsilon, [](const Point& p) { return p; });
+			if(hasData(mask, FDataType::vn))
+				vn = weldBuffer(normals, epsilon, [](const Point& p) { return p; });
+			if(hasData(mask, FDataType::vt))
+				vt = weldBuffer(texCoords, epsilon, [](const TexCoord& t) { return Point{ t.u, t.v, t.w, 0 }; });
+			if(hasData(mask, FDataType::co))
+				co = weldBuffer(colors, epsilon, [](const Color& c) { return Point{ c.r / 255.f, c.g / 255.f, c.b / 255.f, c.a / 255.f }; });
+
+			remapAttributeIndices(v, vn, vt, co);
+			return *this;
+		}
+
+		/**
+		 * Removes the vertices, normals, texture coordinates and colors no tetrahedron or polyline points to, and
+		 * the cell entries pointing to tetrahedra that don't exist. Rewrites all indices to match and releases excess capacity.
+		 * Buffers shared with other Objects keep their capacity, since shrinking them would mean copying them.
+		 * Marking and remapping run in parallel.
+		 * @returns The amount of bytes reclaimed (see `memoryUsage`), not counting data shared with other Objects.
+		 */
+		size_t compact()
+		{
+			// measured per buffer, so data copied out of a shared buffer doesn't eat into what the others reclaimed
+			auto forEachBuffer = [this](auto&& f)
+				{
+					f(0, vertices); f(1, normals); f(2, texCoords); f(3, colors);
+					f(4, tetrahedra); f(5, polylines); f(6, cells);
+				};
+			size_t before[7];
+			bool owned[7];
+			forEachBuffer([&](size_t i, const auto& buffer)
+				{
+					owned[i] = !buffer.isShared();
+					before[i] = bufferMemory(buffer);
+				});
+
+			// mark what's referenced; several threads can mark the same element, so the marks are written atomically
+			std::vector<uint8_t> marks[4] = {
+				std::vector<uint8_t>(vertices.size(), 0),
+				std::vector<uint8_t>(normals.size(), 0),
+				std::vector<uint8_t>(texCoords.size(), 0),
+				std::vector<uint8_t>(colors.size(), 0),
+			};
+			auto mark = [](std::vector<uint8_t>& m, int32_t ind)
+				{
+					if(ind >= 0 && ind < (int32_t)m.size())
+						std::atomic_ref<uint8_t>(m[ind]).store(1, std::memory_order_relaxed);
+				};
+			auto markAll = [&](const auto& buffer)
+				{
+					const auto& data = buffer.get();
+					Parallel::forChunks(data.size(), [&](size_t begin, size_t end)
+						{
+							for(size_t i = begin; i < end; i++)
+							{
+								for(int32_t ind : data[i].vIndices) mark(marks[0], ind);
+								for(int32_t ind : data[i].vnIndices) mark(marks[1], ind);
+								for(int32_t ind : data[i].vtIndices) mark(marks[2], ind);
+								for(int32_t ind : data[i].coIndices) mark(marks[3], ind);
+							}
+						});
+				};
+			markAll(tetrahedra);
+			markAll(polylines);
+
+			std::vector<int32_t> v = compactBuffer(vertices, marks[0]);
+			std::vector<int32_t> vn = compactBuffer(normals, marks[1]);
+			std::vector<int32_t> vt = compactBuffer(texCoords, marks[2]);
+			std::vector<int32_t> co = compactBuffer(colors, marks[3]);
+			remapAttributeIndices(v, vn, vt, co);
+
+			const int32_t tetCount = (int32_t)tetrahedra.size();
+			bool cellsValid = true;
+			for(const Cell& c : cells.get())
+				for(int32_t t : c.tIndices)
+					cellsValid &= t >= 0 && t < tetCount;
+			if(!cellsValid)
 			{
-				Polyline newPl{pl};
+				for(Cell& c : cells.mutate())
+				{
+					std::erase_if(c.tIndices, [&](int32_t t) { return t < 0 || t >= tetCount; });
+					c.tIndices.shrink_to_fit();
+				}
+			}
+
+			if(tetrahedra.capacity() > tetrahedra.size() && !tetrahedra.isShared()) tetrahedra.shrink_to_fit();
+			if(polylines.capacity() > polylines.size() && !polylines.isShared()) polylines.shrink_to_fit();
+			if(cells.capacity() > cells.size() && !cells.isShared()) cells.shrink_to_fit();
+
+			size_t reclaimed = 0;
+			forEachBuffer([&](size_t i, const auto& buffer)
+				{
+					if(!owned[i] || buffer.isShared())
+						return;
+					const size_t after = bufferMemory(buffer);
+					reclaimed += before[i] > after ? before[i] - after : 0;
+				});
+			return reclaimed;
+		}
+
+		// The heap memory held by the Object's buffers, in bytes. Buffers shared with other Objects are counted fully.
+		size_t memoryUsage() const
+		{
+			return bufferMemory(vertices) + bufferMemory(normals) + bufferMemory(texCoords) + bufferMemory(colors)
+				+ bufferMemory(tetrahedra) + bufferMemory(polylines) + bufferMemory(cells);
+		}
+
+		/**
+		 * Sorts the vertices along a 4D space-filling curve through the Object's bounds, then the tetrahedra by the curve
+		 * position of their centroids, and rewrites the tetrahedron, polyline and cell indices to match.
+		 * Elements close in space end up close in memory, which helps everything walking the tetrahedra and fetching their vertices.
+		 * Keys are computed in parallel and sorted with a parallel radix sort; equal keys keep their relative order.
+		 * @param curve The space-filling curve to sort along.
+		 * @return *this (for chaining)
+		 */
+		Object& reorder(Curve curve = Curve::Hilbert4D)
+		{
+			const AABB4 bounds = getBounds();
 
-				for(auto& ind : newPl.vIndices)
-					ind += startV;
-				for(auto& ind : newPl.vnIndices)
-					ind += startVN;
-				for(auto& ind : newPl.vtIndices)
-					ind += startVT;
-				for(auto& ind : newPl.coIndices)
-					ind += startCO;
+			if(vertices.size() > 1)
+			{
+				const std::vector<Point>& verts = vertices.get();
+				std::vector<uint64_t> keys(verts.size());
+				std::vector<uint32_t> order(verts.size());
+				Parallel::forChunks(verts.size(), [&](size_t begin, size_t end)
+					{
+						for(size_t i = begin; i < end; i++)
+						{
+							keys[i] = curveKeyOf(curve, bounds, verts[i]);
+							order[i] = (uint32_t)i;
+						}
+					});
+				Parallel::radixSort(keys, order);
 
-				polylines.emplace_back(newPl);
+				std::vector<Point> sorted(verts.size());
+				std::vector<int32_t> map(verts.size());
+				Parallel::forChunks(verts.size(), [&](size_t begin, size_t end)
+					{
+						for(size_t i = begin; i < end; i++)
+						{
+							sorted[i] = verts[order[i]];
+							map[order[i]] = (int32_t)i;
+						}
+					});
+				vertices = std::move(sorted);
+				remapAttributeIndices(map, {}, {}, {});
 			}
-			for(auto& c : other.cells)
+
+			if(tetrahedra.size() > 1)
 			{
-				Cell newC{c};
+				const std::vector<Tetrahedron>& tets = tetrahedra.get();
+				const std::vector<Point>& verts = vertices.get();
+				std::vector<uint64_t> keys(tets.size());
+				std::vector<uint32_t> order(tets.size());
+				Parallel::forChunks(tets.size(), [&](size_t begin, size_t end)
+					{
+						for(size_t i = begin; i < end; i++)
+						{
+							order[i] = (uint32_t)i;
+							Point centroid{ 0,0,0,0 };
+							bool valid = true;
+							for(int32_t v : tets[i].vIndices)
+							{
+								if(v < 0 || v >= (int32_t)verts.size())
+								{
+									valid = false;
+									break;
+								}
+								centroid += verts[v];
+							}
+							// tetrahedra without a position go last
+							keys[i] = valid ? curveKeyOf(curve, bounds, centroid * 0.25f) : std::numeric_limits<uint64_t>::max();
+						}
+					});
+				Parallel::radixSort(keys, order);
 
-				for(auto& ind : newC.tIndices)
-					ind += startT;
+				std::vector<Tetrahedron> sorted(tets.size());
+				std::vector<int32_t> map(tets.size());
+				Parallel::forChunks(tets.size(), [&](size_t begin, size_t end)
+					{
+						for(size_t i = begin; i < end; i++)
+						{
+							sorted[i] = tets[order[i]];
+							map[order[i]] = (int32_t)i;
+						}
+					});
+				tetrahedra = std::move(sorted);
 
-				cells.emplace_back(newC);
+				if(!cells.empty())
+				{
+					std::vector<Cell>& data = cells.mutate();
+					Parallel::forChunks(data.size(), [&](size_t begin, size_t end)
+						{
+							for(size_t i = begin; i < end; i++)
+								remapIndices(data[i].tIndices, map);
+						});
+				}
 			}
 
 			return *this;
 		}
 
 		/**
-		 * @return The median point of all vertices.
+		 * The bounds and the center are computed together in one pass and cached until the vertices change.
+		 * @return The axis-aligned bounding box of all vertices. Empty if there are no vertices.
 		 */
-		Point getCenter()
+		AABB4 getBounds() const
 		{
-			if(vertices.empty()) return {0,0,0,0};
-
-			Point center{};
-			int i = 0;
+			std::lock_guard lock(_boundsCache.mutex);
+			return updateBoundsCache().bounds;
+		}
 
-			for(auto& v : vertices)
-			{
-				center += v;
-				i++;
-			}
+		/**
+		 * The bounds and the center are computed together in one pass and cached until the vertices change.
+		 * @return The median point of all vertices.
+		 */
+		Point getCenter() const
+		{
+			std::lock_guard lock(_boundsCache.mutex);
+			return updateBoundsCache().center;
+		}
 
-			center /= i;
+		/**
+		 * The bounding box and sphere of every cell, computed in parallel from its tetrahedra's vertices.
+		 * Cached until the vertices, tetrahedra or cells change; `translate` and uniform `scale` move the cache along instead.
+		 * @return One CellBounds per cell.
+		 */
+		std::vector<CellBounds> getCellBounds() const
+		{
+			std::lock_guard lock(_cellBoundsCache.mutex);
+			return updateCellBoundsCache();
+		}
 
-			return center;
+		/**
+		 * Finds the cells that might cross the hyperplane `dot(normal, p) == offset`, i.e. the only ones slicing there can hit.
+		 * Tests the cached cell bounds (see getCellBounds) in parallel.
+		 * @param out The output. Its buffers are reused, so pass the same one every frame to avoid allocations.
+		 */
+		void cullCells(const Point& normal, float offset, CulledCells& out) const
+		{
+			const Hyperplane4 plane{ normal, offset };
+			cullCellsWhere(out, [&](const CellBounds& b) { return b.crosses(plane); });
+		}
+		/**
+		 * Finds the cells that might be inside a convex volume (e.g. the 4D view volume), bounded by `planes`.
+		 * Tests the cached cell bounds (see getCellBounds) in parallel.
+		 * @param planes The bounding hyperplanes, their outside (`dot(normal, p) > offset`) pointing away from the volume.
+		 * @param out The output. Its buffers are reused, so pass the same one every frame to avoid allocations.
+		 */
+		void cullCells(std::span<const Hyperplane4> planes, CulledCells& out) const
+		{
+			cullCellsWhere(out, [&](const CellBounds& b)
+				{
+					for(const Hyperplane4& plane : planes)
+						if(!b.inside(plane))
+							return false;
+					return !b.isEmpty();
+				});
 		}
 
 		/**
@@ -1163,8 +1849,13 @@ namespace fdo
 		 */
 		Object& translate(const Point& v)
 		{
-			for(auto& vert : vertices)
-				vert += v;
+			keepCellBounds([&] { runKernel(vertices, [&](float* data, size_t count) { simd::add4(data, count, { v.x, v.y, v.z, v.w }); }); },
+				[&](CellBounds& b)
+				{
+					b.box.min += v;
+					b.box.max += v;
+					b.center += v;
+				});
 
 			return *this;
 		}
@@ -1176,8 +1867,30 @@ namespace fdo
 		 */
 		Object& scale(const Point& v, const Point& origin)
 		{
-			for(auto& vert : vertices)
-				vert = origin + (vert - origin) * v;
+			auto run = [&]
+				{
+					runKernel(vertices, [&](float* data, size_t count)
+						{
+							simd::scale4(data, count, { v.x, v.y, v.z, v.w }, { origin.x, origin.y, origin.z, origin.w });
+						});
+				};
+			const float s = std::abs(v.x);
+			if(s != std::abs(v.y) || s != std::abs(v.z) || s != std::abs(v.w))
+			{
+				// the cell bounds would only stay conservative, not tight, let them get recomputed
+				run();
+				return *this;
+			}
+
+			keepCellBounds(run, [&](CellBounds& b)
+				{
+					const Point a = (b.box.min - origin) * v + origin;
+					const Point c = (b.box.max - origin) * v + origin;
+					b.box.min = { std::min(a.x, c.x), std::min(a.y, c.y), std::min(a.z, c.z), std::min(a.w, c.w) };
+					b.box.max = { std::max(a.x, c.x), std::max(a.y, c.y), std::max(a.z, c.z), std::max(a.w, c.w) };
+					b.center = (b.center - origin) * v + origin;
+					b.radius *= s;
+				});
 
 			return *this;
 		}
@@ -1188,102 +1901,179 @@ namespace fdo
 		 */
 		Object& scale(const Point& v) { return scale(v, getCenter()); }
 		/**
-		 * Applies whatever transformation you want.
-		 * @param verticesT The transformation function.
+		 * Applies an affine transformation to the vertices and normals.
+		 * Normals are transformed by the inverse transpose of the matrix and get re-normalized.
+		 * @param m The transformation matrix.
 		 * @return *this (for chaining)
 		 */
-		Object& transformVertices(
-			const std::function<Point(const Point& vertex)>& verticesT)
+		Object& applyTransform(const Mat5& m)
 		{
-			for(auto& vert : vertices)
-				vert = verticesT(vert);
+			float linear[16];
+			float translation[4];
+
+			m.toArrays(linear, translation);
+			runKernel(vertices, [&](float* data, size_t count) { simd::transform4(data, count, linear, translation); });
+
+			if(!normals.empty())
+			{
+				float normalLinear[16];
+				m.normalMatrix().toArrays(normalLinear, translation);
+				runKernel(normals, [&](float* data, size_t count) { simd::transformNormalize4(data, count, normalLinear); });
+			}
 
 			return *this;
 		}
 		/**
 		 * Applies whatever transformation you want.
-		 * @param normalsT The transformation function.
+		 * @param verticesT The transformation function. Any callable taking a `const Point&` and returning a Point.
+		 * @param execution With Execution::Parallel, it may get called from multiple threads at once, see fdo::Parallel.
 		 * @return *this (for chaining)
 		 */
-		Object& transformNormals(
-			const std::function<Point(const Point& normal)>& normalsT)
+		template<typename F> requires std::is_invocable_r_v<Point, F&, const Point&>
+		Object& transformVertices(F&& verticesT, Execution execution = Execution::Serial)
 		{
-			for(auto& n : normals)
-				n = normalsT(n);
+			forEachElement(vertices, verticesT, execution);
 
 			return *this;
 		}
 		/**
 		 * Applies whatever transformation you want.
-		 * @param texCoordsT The transformation function.
+		 * @param normalsT The transformation function. Any callable taking a `const Point&` and returning a Point.
+		 * @param execution With Execution::Parallel, it may get called from multiple threads at once, see fdo::Parallel.
 		 * @return *this (for chaining)
 		 */
-		Object& transformTexCoords(
-			const std::function<TexCoord(const TexCoord& texCoord)>& texCoordsT)
+		template<typename F> requires std::is_invocable_r_v<Point, F&, const Point&>
+		Object& transformNormals(F&& normalsT, Execution execution = Execution::Serial)
 		{
-			for(auto& texCoord : texCoords)
-				texCoord = texCoordsT(texCoord);
+			forEachElement(normals, normalsT, execution);
 
 			return *this;
 		}
 		/**
 		 * Applies whatever transformation you want.
-		 * @param colorsT The transformation function.
+		 * @param texCoordsT The transformation function. Any callable taking a `const TexCoord&` and returning a TexCoord.
+		 * @param execution With Execution::Parallel, it may get called from multiple threads at once, see fdo::Parallel.
 		 * @return *this (for chaining)
 		 */
-		Object& transformColors(
-			const std::function<Color(const Color& color)>& colorsT)
+		template<typename F> requires std::is_invocable_r_v<TexCoord, F&, const TexCoord&>
+		Object& transformTexCoords(F&& texCoordsT, Execution execution = Execution::Serial)
 		{
-			for(auto& color : colors)
-				color = colorsT(color);
+			forEachElement(texCoords, texCoordsT, execution);
 
 			return *this;
 		}
 		/**
 		 * Applies whatever transformation you want.
-		 * @param verticesT,normalsT,texCoordsT,colorsT The transformation functions.
+		 * @param colorsT The transformation function. Any callable taking a `const Color&` and returning a Color.
+		 * @param execution With Execution::Parallel, it may get called from multiple threads at once, see fdo::Parallel.
 		 * @return *this (for chaining)
 		 */
-		Object& transform(
-			const std::function<Point(const Point& vertex)>& verticesT,
-			const std::function<Point(const Point& normal)>& normalsT,
-			const std::function<TexCoord(const TexCoord& texCoord)>& texCoordsT,
-			const std::function<Color(const Color& color)>& colorsT)
+		template<typename F> requires std::is_invocable_r_v<Color, F&, const Color&>
+		Object& transformColors(F&& colorsT, Execution execution = Execution::Serial)
 		{
-			transformVertices(verticesT);
-			transformNormals(normalsT);
-			transformTexCoords(texCoordsT);
-			transformColors(colorsT);
+			forEachElement(colors, colorsT, execution);
 
 			return *this;
 		}
-
-		std::string save4DO(const std::vector<std::string>& comments)
+		/**
+		 * Applies whatever transformation you want.
+		 * @param verticesT,normalsT,texCoordsT,colorsT The transformation functions.
+		 * @param execution With Execution::Parallel, they may get called from multiple threads at once, see fdo::Parallel.
+		 * @return *this (for chaining)
+		 */
+		template<typename FV, typename FN, typename FT, typename FC>
+		Object& transform(FV&& verticesT, FN&& normalsT, FT&& texCoordsT, FC&& colorsT, Execution execution = Execution::Serial)
 		{
-			std::string result = "# Generated with 4DO-Lib\n";
+			transformVertices(std::forward<FV>(verticesT), execution);
+			transformNormals(std::forward<FN>(normalsT), execution);
+			transformTexCoords(std::forward<FT>(texCoordsT), execution);
+			transformColors(std::forward<FC>(colorsT), execution);
 
-			for(auto& comment : comments)
-				result += std::format("# {}\n", comment);
+			return *this;
+		}
 
-			result += "\n# Header\n";
-			result += std::format("4DO {}\n", specVer);
-			result += std::format("orient {}\n", orientation.toString());
-			if(!tetrahedra.empty())
-			{
-				tformat = tetrahedra[0].guessFormat();
-				result += std::format("tformat {}\n", tformat.toString());
-			}
-			if(!polylines.empty())
-			{
-				pformat = polylines[0].guessFormat();
-				result += std::format("pformat {}\n", pformat.toString());
-			}
+		// Batched variants. The callable gets the data in consecutive spans of at most `batchSize` elements,
+		// which lets it run its own vectorized loop instead of being called once per element.
 
-			if(!colors.empty())
-			{
-				result += "\n# Colors\n";
+		/**
+		 * Applies whatever transformation you want, a batch at a time.
+		 * @param verticesT The transformation function. Any callable taking a `std::span<Point>` and modifying it in-place.
+		 * @param batchSize The max amount of elements per call.
+		 * @param execution With Execution::Parallel, spans may be handed out to multiple threads at once.
+		 * @return *this (for chaining)
+		 */
+		template<typename F> requires std::is_invocable_v<F&, std::span<Point>>
+		Object& transformVerticesBatch(F&& verticesT, size_t batchSize = defaultBatchSize, Execution execution = Execution::Serial)
+		{
+			forEachBatch(vertices, verticesT, batchSize, execution);
+			return *this;
+		}
+		/**
+		 * Applies whatever transformation you want, a batch at a time.
+		 * @param normalsT The transformation function. Any callable taking a `std::span<Point>` and modifying it in-place.
+		 * @param batchSize The max amount of elements per call.
+		 * @param execution With Execution::Parallel, spans may be handed out to multiple threads at once.
+		 * @return *this (for chaining)
+		 */
+		template<typename F> requires std::is_invocable_v<F&, std::span<Point>>
+		Object& transformNormalsBatch(F&& normalsT, size_t batchSize = defaultBatchSize, Execution execution = Execution::Serial)
+		{
+			forEachBatch(normals, normalsT, batchSize, execution);
+			return *this;
+		}
+		/**
+		 * Applies whatever transformation you want, a batch at a time.
+		 * @param texCoordsT The transformation function. Any callable taking a `std::span<TexCoord>` and modifying it in-place.
+		 * @param batchSize The max amount of elements per call.
+		 * @param execution With Execution::Parallel, spans may be handed out to multiple threads at once.
+		 * @return *this (for chaining)
+		 */
+		template<typename F> requires std::is_invocable_v<F&, std::span<TexCoord>>
+		Object& transformTexCoordsBatch(F&& texCoordsT, size_t batchSize = defaultBatchSize, Execution execution = Execution::Serial)
+		{
+			forEachBatch(texCoords, texCoordsT, batchSize, execution);
+			return *this;
+		}
+		/**
+		 * Applies whatever transformation you want, a batch at a time.
+		 * @param colorsT The transformation function. Any callable taking a `std::span<Color>` and modifying it in-place.
+		 * @param batchSize The max amount of elements per call.
+		 * @param execution With Execution::Parallel, spans may be handed out to multiple threads at once.
+		 * @return *this (for chaining)
+		 */
+		template<typename F> requires std::is_invocable_v<F&, std::span<Color>>
+		Object& transformColorsBatch(F&& colorsT, size_t batchSize = defaultBatchSize, Execution execution = Execution::Serial)
+		{
+			forEachBatch(colors, colorsT, batchSize, execution);
+			return *this;
+		}
+
+		std::string save4DO(const std::vector<std::string>& comments)
+		{
+			std::string result = "# Generated with 4DO-Lib\n";
+
+			for(auto& comment : comments)
+				result += std::format("# {}\n", comment);
+
+			result += "\n# Header\n";
+			result += std::format("4DO {}\n", specVer);
+			result += std::format("orient {}\n", orientation.toString());
+			if(!tetrahedra.empty())
+			{
+				tformat = tetrahedra[0].guessFormat();
+				result += std::format("tformat {}\n", tformat.toString());
+			}
+			if(!polylines.empty())
+			{
+				pformat = polylines[0].guessFormat();
+				result += std::format("pformat {}\n", pformat.toString());
+			}
+
+			if(!colors.empty())
+			{
+				result += "\n# Colors\n";
 
-				for (auto& color : colors)
+				for (auto& color : std::as_const(colors))
 					result += std::format("co {}\n", color.toString());
 			}
 
@@ -1291,7 +2081,7 @@ namespace fdo
 			{
 				result += "\n# Vertices\n";
 
-				for (auto& vert : vertices)
+				for (auto& vert : std::as_const(vertices))
 					result += std::format("v {}\n", vert.toString());
 			}
 
@@ -1299,7 +2089,7 @@ namespace fdo
 			{
 				result += "\n# Normals\n";
 
-				for (auto& n : normals)
+				for (auto& n : std::as_const(normals))
 					result += std::format("vn {}\n", n.toString());
 			}
 
@@ -1307,7 +2097,7 @@ namespace fdo
 			{
 				result += "\n# Texture Coordinates\n";
 
-				for (auto& tc : texCoords)
+				for (auto& tc : std::as_const(texCoords))
 					result += std::format("vt {}\n", tc.toString());
 			}
 
@@ -1315,7 +2105,7 @@ namespace fdo
 			{
 				result += "\n# Tetrahedra\n";
 
-				for (auto& t : tetrahedra)
+				for (auto& t : std::as_const(tetrahedra))
 					result += std::format("t {}\n", t.toString(tformat));
 			}
 
@@ -1323,7 +2113,7 @@ namespace fdo
 			{
 				result += "\n# Cells\n";
 
-				for (auto& c : cells)
+				for (auto& c : std::as_const(cells))
 					result += std::format("c {}\n", c.toString());
 			}
 
@@ -1331,7 +2121,7 @@ namespace fdo
 			{
 				result += "\n# Polylines\n";
 
-				for (auto& p : polylines)
+				for (auto& p : std::as_const(polylines))
 					result += std::format("p {}\n", p.toString(pformat));
 			}
 
@@ -1377,6 +2167,7 @@ namespace fdo
 		 * @param uvw The output vertex texture coordinates. Can be left NULL if you don't need it.
 		 * @param col The output vertex colors. Can be left NULL if you don't need it.
 		 * @param optimizeData When `true`, will try to optimize the output data.
+		 * @param scratch Working memory to reuse between calls, see TetrahedralizeScratch. Can be left NULL.
 		 */
 		void tetrahedralize(
 			std::vector<uint32_t>& indexBuffer,
@@ -1384,155 +2175,1618 @@ namespace fdo
 			std::vector<fdo::Point>* norm = nullptr,
 			std::vector<fdo::TexCoord>* uvw = nullptr,
 			std::vector<fdo::Color>* col = nullptr,
-			bool optimizeData = true
-		)
+			bool optimizeData = true,
+			TetrahedralizeScratch* scratch = nullptr
+		) const
+		{
+			tetrahedralize(indexBuffer, pos, norm, uvw, col, optimizeData ? Dedup::ByValue : Dedup::None, scratch);
+		}
+
+		/**
+		 * Converts the Object data into GPU-compatible single index buffer format.
+		 * `Dedup::ByIndex` never expands the corners: it merges them by their attribute indices in a single pass
+		 * and writes every unique vertex once, so it's the fastest way to get an optimized buffer.
+		 * @param indexBuffer The output indices.
+		 * @param pos The output vertex positions. Can be left NULL if you don't need it.
+		 * @param norm The output vertex normals. Can be left NULL if you don't need it.
+		 * @param uvw The output vertex texture coordinates. Can be left NULL if you don't need it.
+		 * @param col The output vertex colors. Can be left NULL if you don't need it.
+		 * @param dedup How to merge the corners into shared vertices.
+		 * @param scratch Working memory to reuse between calls, see TetrahedralizeScratch. Can be left NULL.
+		 */
+		void tetrahedralize(
+			std::vector<uint32_t>& indexBuffer,
+			std::vector<fdo::Point>* pos,
+			std::vector<fdo::Point>* norm,
+			std::vector<fdo::TexCoord>* uvw,
+			std::vector<fdo::Color>* col,
+			Dedup dedup,
+			TetrahedralizeScratch* scratch = nullptr
+		) const
 		{
 			if (!pos && !norm && !uvw && !col)
 				return;
 
-			if (pos)
+			DataMask attributes = DataMask::None;
+			if (pos) attributes |= DataMask::v;
+			if (norm) attributes |= DataMask::vn;
+			if (uvw) attributes |= DataMask::vt;
+			if (col) attributes |= DataMask::co;
+
+			TetrahedralizeScratch localScratch;
+			TetrahedralizeScratch& s = scratch ? *scratch : localScratch;
+			mergeCorners(s, indexBuffer, attributes, dedup);
+			fetchVertices(s._corners, pos, norm, uvw, col, [this](uint32_t corner, Point* pos, Point* norm, TexCoord* uvw, Color* col)
+				{
+					fetchCorner(corner, pos, norm, uvw, col);
+				});
+		}
+
+		/**
+		 * Converts the Object data into GPU-compatible single index buffer format, writing interleaved vertices
+		 * straight into caller-owned memory (e.g. a mapped staging buffer).
+		 * If `vertexData` is too small, only `indexBuffer` gets written. Size it up front with `tetrahedralizeSize`,
+		 * or with `layout.bytes(tetrahedra.size() * 4)`, which is always enough.
+		 * @param indexBuffer The output indices.
+		 * @param layout Which attributes to write, how and where.
+		 * @param vertexData The output vertices.
+		 * @param dedup How to merge the corners into shared vertices.
+		 * @param scratch Working memory to reuse between calls, see TetrahedralizeScratch. Can be left NULL.
+		 * @returns The amount of bytes the vertices take up, or 0 if the layout is invalid.
+		 */
+		size_t tetrahedralize(
+			std::vector<uint32_t>& indexBuffer,
+			const VertexLayout& layout,
+			std::span<std::byte> vertexData,
+			Dedup dedup = Dedup::ByIndex,
+			TetrahedralizeScratch* scratch = nullptr
+		) const
+		{
+			if (!layout.isValid())
 			{
-				pos->clear();
-				pos->reserve(tetrahedra.size() * 4);
+				Logger::logError("fdo::Object::tetrahedralize: Invalid vertex layout.");
+				indexBuffer.clear();
+				return 0;
 			}
-			if (norm)
+
+			TetrahedralizeScratch localScratch;
+			TetrahedralizeScratch& s = scratch ? *scratch : localScratch;
+			mergeCorners(s, indexBuffer, layout.mask(), dedup);
+			const std::vector<uint32_t>& corners = s._corners;
+
+			const size_t bytes = layout.bytes(corners.size());
+			if (bytes <= vertexData.size())
+				writeVertices(corners, layout, vertexData.data());
+			return bytes;
+		}
+
+		/**
+		 * The amount of bytes `tetrahedralize` with the same `layout` and `dedup` writes to its vertex data.
+		 * Has to merge the corners to find out, so it costs about as much as the merge itself.
+		 * @param scratch Working memory to reuse between calls, see TetrahedralizeScratch. Can be left NULL.
+		 * @returns The size in bytes, or 0 if the layout is invalid.
+		 */
+		size_t tetrahedralizeSize(const VertexLayout& layout, Dedup dedup = Dedup::ByIndex, TetrahedralizeScratch* scratch = nullptr) const
+		{
+			if (!layout.isValid())
+				return 0;
+
+			TetrahedralizeScratch localScratch;
+			TetrahedralizeScratch& s = scratch ? *scratch : localScratch;
+			mergeCorners(s, s._indexBuffer, layout.mask(), dedup);
+			return layout.bytes(s._corners.size());
+		}
+
+		/**
+		 * Converts the Object data into GPU-compatible single index buffer format, writing both the interleaved vertices
+		 * and the indices straight into caller-owned memory, in compact formats if wanted (see VertexFormat and IndexFormat).
+		 * Nothing gets written unless both buffers are big enough, so calling it with empty spans works as a sizing query.
+		 * @param layout Which attributes to write, how and where.
+		 * @param vertexData The output vertices.
+		 * @param indexData The output indices.
+		 * @param indexFormat The type of the output indices. UInt16 fails if there are more than 65536 vertices.
+		 * @param dedup How to merge the corners into shared vertices.
+		 * @param scratch Working memory to reuse between calls, see TetrahedralizeScratch. Can be left NULL.
+		 * @returns What was written (or would be), see TetrahedralizeInfo.
+		 */
+		TetrahedralizeInfo tetrahedralize(
+			const VertexLayout& layout,
+			std::span<std::byte> vertexData,
+			std::span<std::byte> indexData,
+			IndexFormat indexFormat = IndexFormat::Auto,
+			Dedup dedup = Dedup::ByIndex,
+			TetrahedralizeScratch* scratch = nullptr
+		) const
+		{
+			if (!layout.isValid())
 			{
-				norm->clear();
-				norm->reserve(tetrahedra.size() * 4);
+				Logger::logError("fdo::Object::tetrahedralize: Invalid vertex layout.");
+				return {};
 			}
-			if (uvw)
+
+			TetrahedralizeScratch localScratch;
+			TetrahedralizeScratch& s = scratch ? *scratch : localScratch;
+			mergeCorners(s, s._indexBuffer, layout.mask(), dedup);
+			return writeBuffers("tetrahedralize", s, layout, vertexData, indexData, indexFormat,
+				[this](uint32_t corner, Point* pos, Point* norm, TexCoord* uvw, Color* col)
+				{
+					fetchCorner(corner, pos, norm, uvw, col);
+				});
+		}
+
+		/**
+		 * Converts the Object data into GPU-compatible single index buffer format like tetrahedralize, but with the
+		 * tetrahedra ordered by cell, so every cell can be culled and drawn on its own.
+		 * The vertices come out exactly as from tetrahedralize with the same `dedup`.
+		 * Tetrahedra in several cells get written once per cell; the ones in no cell go into an extra range at the end.
+		 * Like tetrahedralize, does nothing unless at least one of the vertex outputs is requested.
+		 * @param indexBuffer The output indices.
+		 * @param cellRanges The output ranges, one per cell, plus one for the tetrahedra in no cell.
+		 * @param pos The output vertex positions. Can be left NULL if you don't need it.
+		 * @param norm The output vertex normals. Can be left NULL if you don't need it.
+		 * @param uvw The output vertex texture coordinates. Can be left NULL if you don't need it.
+		 * @param col The output vertex colors. Can be left NULL if you don't need it.
+		 * @param tetlets When not NULL, also splits every range into tetlets, using the limits set in it.
+		 * @param dedup How to merge the corners into shared vertices.
+		 * @param scratch Working memory to reuse between calls, see TetrahedralizeScratch. Can be left NULL.
+		 */
+		void tetrahedralizeCells(
+			std::vector<uint32_t>& indexBuffer,
+			std::vector<DrawRange>& cellRanges,
+			std::vector<fdo::Point>* pos = nullptr,
+			std::vector<fdo::Point>* norm = nullptr,
+			std::vector<fdo::TexCoord>* uvw = nullptr,
+			std::vector<fdo::Color>* col = nullptr,
+			Tetlets* tetlets = nullptr,
+			Dedup dedup = Dedup::ByIndex,
+			TetrahedralizeScratch* scratch = nullptr
+		) const
+		{
+			if (!pos && !norm && !uvw && !col)
+				return;
+
+			DataMask attributes = DataMask::None;
+			if (pos) attributes |= DataMask::v;
+			if (norm) attributes |= DataMask::vn;
+			if (uvw) attributes |= DataMask::vt;
+			if (col) attributes |= DataMask::co;
+
+			TetrahedralizeScratch localScratch;
+			TetrahedralizeScratch& s = scratch ? *scratch : localScratch;
+			mergeCorners(s, s._indexBuffer, attributes, dedup);
+			fetchVertices(s._corners, pos, norm, uvw, col, [this](uint32_t corner, Point* pos, Point* norm, TexCoord* uvw, Color* col)
+				{
+					fetchCorner(corner, pos, norm, uvw, col);
+				});
+
+			// list the tetrahedra cell by cell, then the leftovers
+			const std::vector<Cell>& cellList = cells.get();
+			const size_t tetCount = tetrahedra.size();
+			std::vector<uint32_t>& order = s._cellTetrahedra;
+			std::vector<uint8_t>& inCell = s._inCell;
+			order.clear();
+			inCell.assign(tetCount, 0);
+			cellRanges.resize(cellList.size() + 1);
+			for (size_t c = 0; c <= cellList.size(); ++c)
 			{
-				uvw->clear();
-				uvw->reserve(tetrahedra.size() * 4);
+				const size_t first = order.size();
+				if (c < cellList.size())
+				{
+					for (int32_t t : cellList[c].tIndices)
+						if (t >= 0 && (size_t)t < tetCount)
+						{
+							order.push_back((uint32_t)t);
+							inCell[t] = 1;
+						}
+				}
+				else
+				{
+					for (uint32_t t = 0; t < tetCount; ++t)
+						if (!inCell[t])
+							order.push_back(t);
+				}
+				cellRanges[c] = { (uint32_t)(first * 4), (uint32_t)((order.size() - first) * 4), {} };
 			}
-			if (col)
+
+			indexBuffer.resize(order.size() * 4);
+			Parallel::forChunks(order.size(), [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++i)
+						std::memcpy(&indexBuffer[i * 4], &s._indexBuffer[(size_t)order[i] * 4], 4 * sizeof(uint32_t));
+				});
+			Parallel::forChunks(cellRanges.size(), [&](size_t begin, size_t end)
+				{
+					for (size_t c = begin; c < end; ++c)
+						for (uint32_t i = cellRanges[c].firstIndex / 4; i < (cellRanges[c].firstIndex + cellRanges[c].indexCount) / 4; ++i)
+							expandTetrahedron(cellRanges[c].bounds, order[i]);
+				}, std::max<size_t>(Parallel::getChunkSize() / 256, 1));
+
+			if (tetlets)
+				buildTetlets(*tetlets, s, indexBuffer, cellRanges);
+		}
+
+		/**
+		 * Converts the polylines into a GPU-compatible line list: a single index buffer with 2 indices per segment,
+		 * into vertex buffers merged the same way as in tetrahedralize, with polyline points in place of tetrahedron corners.
+		 * Polylines shorter than 2 points are skipped. Vertices are numbered in the order the points are first seen.
+		 * @param indexBuffer The output indices.
+		 * @param pos The output vertex positions. Can be left NULL if you don't need it.
+		 * @param norm The output vertex normals. Can be left NULL if you don't need it.
+		 * @param uvw The output vertex texture coordinates. Can be left NULL if you don't need it.
+		 * @param col The output vertex colors. Can be left NULL if you don't need it.
+		 * @param dedup How to merge the points into shared vertices. With Dedup::None, every point is its own vertex.
+		 * @param scratch Working memory to reuse between calls, see TetrahedralizeScratch. Can be left NULL.
+		 */
+		void linearize(
+			std::vector<uint32_t>& indexBuffer,
+			std::vector<fdo::Point>* pos = nullptr,
+			std::vector<fdo::Point>* norm = nullptr,
+			std::vector<fdo::TexCoord>* uvw = nullptr,
+			std::vector<fdo::Color>* col = nullptr,
+			Dedup dedup = Dedup::ByIndex,
+			TetrahedralizeScratch* scratch = nullptr
+		) const
+		{
+			if (!pos && !norm && !uvw && !col)
+				return;
+
+			DataMask attributes = DataMask::None;
+			if (pos) attributes |= DataMask::v;
+			if (norm) attributes |= DataMask::vn;
+			if (uvw) attributes |= DataMask::vt;
+			if (col) attributes |= DataMask::co;
+
+			TetrahedralizeScratch localScratch;
+			TetrahedralizeScratch& s = scratch ? *scratch : localScratch;
+			mergeLinePoints(s, indexBuffer, attributes, dedup);
+			fetchVertices(s._corners, pos, norm, uvw, col, [&s, this](uint32_t point, Point* pos, Point* norm, TexCoord* uvw, Color* col)
+				{
+					fetchLinePoint(s._points[point], pos, norm, uvw, col);
+				});
+		}
+
+		/**
+		 * Converts the polylines into a GPU-compatible line list (see the other overload), writing interleaved vertices and
+		 * indices straight into caller-owned memory, like the matching tetrahedralize overload.
+		 * Nothing gets written if either buffer is too small; the returned sizes tell how big they have to be.
+		 * `layout.bytes(polylineSegmentCount() * 2)` vertex bytes and `polylineSegmentCount() * 8` index bytes are always enough.
+		 * @param layout Which attributes to write, how and where.
+		 * @param vertexData The output vertices.
+		 * @param indexData The output indices.
+		 * @param indexFormat The type of the output indices. UInt16 fails if there are more than 65536 vertices.
+		 * @param dedup How to merge the points into shared vertices.
+		 * @param scratch Working memory to reuse between calls, see TetrahedralizeScratch. Can be left NULL.
+		 * @returns What was written (or would be), see TetrahedralizeInfo.
+		 */
+		TetrahedralizeInfo linearize(
+			const VertexLayout& layout,
+			std::span<std::byte> vertexData,
+			std::span<std::byte> indexData,
+			IndexFormat indexFormat = IndexFormat::Auto,
+			Dedup dedup = Dedup::ByIndex,
+			TetrahedralizeScratch* scratch = nullptr
+		) const
+		{
+			if (!layout.isValid())
 			{
-				col->clear();
-				col->reserve(tetrahedra.size() * 4);
+				Logger::logError("fdo::Object::linearize: Invalid vertex layout.");
+				return {};
 			}
 
-			indexBuffer.clear();
-			indexBuffer.reserve(tetrahedra.size() * 4);
+			TetrahedralizeScratch localScratch;
+			TetrahedralizeScratch& s = scratch ? *scratch : localScratch;
+			mergeLinePoints(s, s._indexBuffer, layout.mask(), dedup);
+			return writeBuffers("linearize", s, layout, vertexData, indexData, indexFormat,
+				[&s, this](uint32_t point, Point* pos, Point* norm, TexCoord* uvw, Color* col)
+				{
+					fetchLinePoint(s._points[point], pos, norm, uvw, col);
+				});
+		}
+
+		/**
+		 * Brings `context` up to date with the Object, redoing only the tetrahedra and attributes that changed since
+		 * its last update (see TetrahedralizeContext). A full rebuild gives the same result as the other overloads,
+		 * incremental updates append new vertices at the end instead.
+		 * @returns `false` if nothing changed since the last update.
+		 */
+		bool tetrahedralize(TetrahedralizeContext& context) const
+		{
+			TetrahedralizeContext& c = context;
+			c._table.setFunctions({ &c }, { &c });
+			c._changedIndices.clear();
+			c._changedVertices.clear();
+			c._rebuilt = false;
+
+			uint64_t versions[TetrahedralizeContext::bufferCount];
+			size_t sizes[TetrahedralizeContext::bufferCount];
+			tetrahedralizeState(versions, sizes);
 
-			for (int tetraIndex = 0; tetraIndex < tetrahedra.size(); ++tetraIndex)
-				for (int vertIndex = 0; vertIndex < 4; ++vertIndex)
+			auto finish = [&]()
 				{
-					if (pos)
-					{
-						auto v = tetrahedra[tetraIndex].vIndices[vertIndex];
-						if (v >= 0 && v < vertices.size())
-							pos->emplace_back(vertices[tetrahedra[tetraIndex].vIndices[vertIndex]]);
-					}
-					if (norm)
-					{
-						auto vn = tetrahedra[tetraIndex].vnIndices[vertIndex];
-						if (vn >= 0 && vn < normals.size())
-							norm->emplace_back(normals[tetrahedra[tetraIndex].vnIndices[vertIndex]]);
-					}
-					if (uvw)
-					{
-						auto vt = tetrahedra[tetraIndex].vtIndices[vertIndex];
-						if (vt >= 0 && vt < texCoords.size())
-							uvw->emplace_back(texCoords[tetrahedra[tetraIndex].vtIndices[vertIndex]]);
-					}
-					if (col)
-					{
-						auto co = tetrahedra[tetraIndex].coIndices[vertIndex];
-						if (co >= 0 && co < colors.size())
-							col->emplace_back(colors[tetrahedra[tetraIndex].coIndices[vertIndex]]);
-					}
-					indexBuffer.emplace_back(tetraIndex * 4 + vertIndex);
-				}
+					std::copy(std::begin(versions), std::end(versions), c._versions);
+					std::copy(std::begin(sizes), std::end(sizes), c._sizes);
+					for (auto& marked : c._marked)
+						marked.clear();
+				};
 
-			// optimize the data
-			if (optimizeData)
+			if (!c._built)
 			{
-				struct HashVertData
+				rebuildTetrahedralizeContext(c);
+				finish();
+				return true;
+			}
+
+			// which buffers changed, and where (a changed attribute buffer without marks changed everywhere,
+			// unmarked tetrahedra get compared with what the context has instead)
+			bool compareCorners = false;
+			auto rangesOf = [&](size_t b) -> bool
 				{
-					fdo::Point pos{ 0,0,0,0 };
-					fdo::Point norm{ 0,0,0,0 };
-					fdo::TexCoord uvw{ 0,0,0 };
-					fdo::Color col{ 0,0,0,0 };
-					constexpr bool operator==(const HashVertData& other) const
+					if (versions[b] == c._versions[b] && c._marked[b].empty() && sizes[b] == c._sizes[b])
+						return false;
+					if (versions[b] != c._versions[b] && c._marked[b].empty())
 					{
-						return pos == other.pos && norm == other.norm && uvw == other.uvw && col == other.col;
+						if (b == 0)
+							compareCorners = true;
+						else
+							c._marked[b].push_back({ 0, std::max(sizes[b], c._sizes[b]) });
 					}
+					return true;
 				};
-				struct hash
+			bool changed = rangesOf(0);
+			bool attributesChanged[4]{};
+			for (size_t k = 0; k < 4; ++k)
+				if (hasData(c._attributes, (FDataType)(k + 1)))
+					changed |= attributesChanged[k] = rangesOf(k + 1);
+			if (!changed)
+			{
+				finish();
+				return false;
+			}
+
+			const size_t oldCorners = c._sizes[0] * 4;
+			const size_t newCorners = sizes[0] * 4;
+			const std::vector<Tetrahedron>& tets = tetrahedra.get();
+			c._dirtyCorners.assign(newCorners, 0);
+
+			// changed and appended tetrahedra
+			for (const auto& r : c._marked[0])
+				for (size_t t = r.begin; t < std::min(r.end, sizes[0]); ++t)
+					std::fill_n(c._dirtyCorners.begin() + t * 4, 4, (uint8_t)1);
+			for (size_t corner = oldCorners; corner < newCorners; ++corner)
+				c._dirtyCorners[corner] = 1;
+			if (compareCorners)
+			{
+				const CornerKeys keys = cornerKeys(c._attributes, c._dedup);
+				Parallel::forChunks(std::min(oldCorners, newCorners), [&](size_t begin, size_t end)
+					{
+						for (size_t corner = begin; corner < end; ++corner)
+							if (!c._dirtyCorners[corner] && !contextCornerMatches(c, keys, corner))
+								c._dirtyCorners[corner] = 1;
+					});
+			}
+
+			// changed attributes: with Dedup::ByIndex, only indices becoming valid or invalid change the merging,
+			// other changes just need the vertices using them to be fetched again
+			bool refetch = false;
+			bool scanCorners = false;
+			for (size_t k = 0; k < 4; ++k)
+			{
+				std::vector<uint8_t>& flags = c._dirtyAttributes[k];
+				flags.clear();
+				if (!attributesChanged[k])
+					continue;
+				const size_t b = k + 1;
+				flags.assign(std::max(sizes[b], c._sizes[b]), 0);
+				for (const auto& r : c._marked[b])
+					std::fill(flags.begin() + std::min(r.begin, flags.size()), flags.begin() + std::min(r.end, flags.size()), (uint8_t)1);
+				// indices past the smaller size became valid or invalid (flag 2)
+				for (size_t i = std::min(sizes[b], c._sizes[b]); i < flags.size(); ++i)
+					flags[i] = 2;
+				if (c._dedup == Dedup::ByIndex)
 				{
-					size_t operator()(const HashVertData& va) const
+					refetch = true;
+					scanCorners |= sizes[b] != c._sizes[b];
+				}
+				else
+					scanCorners = true;
+			}
+			if (scanCorners)
+			{
+				const uint8_t minFlag = c._dedup == Dedup::ByIndex ? 2 : 1;
+				Parallel::forChunks(sizes[0], [&](size_t begin, size_t end)
 					{
-						auto hash_combine = [](size_t& h, auto val)
+						for (size_t t = begin; t < end; ++t)
+						{
+							const Tetrahedron& tet = tets[t];
+							for (int j = 0; j < 4; ++j)
 							{
-								h ^= std::hash<std::decay_t<decltype(val)>>()(val) + 0x9e3779b9 + (h << 6) + (h >> 2);
-							};
+								const int32_t indices[4] = { tet.vIndices[j], tet.vnIndices[j], tet.vtIndices[j], tet.coIndices[j] };
+								for (size_t k = 0; k < 4; ++k)
+								{
+									const std::vector<uint8_t>& flags = c._dirtyAttributes[k];
+									if (indices[k] >= 0 && (size_t)indices[k] < flags.size() && flags[indices[k]] >= minFlag)
+										c._dirtyCorners[t * 4 + j] = 1;
+								}
+							}
+						}
+					}, Parallel::getChunkSize() / 4);
+			}
 
-						size_t h = 0;
-						hash_combine(h, va.pos.x);
-						hash_combine(h, va.pos.y);
-						hash_combine(h, va.pos.z);
-						hash_combine(h, va.norm.x);
-						hash_combine(h, va.norm.y);
-						hash_combine(h, va.norm.z);
-						hash_combine(h, va.uvw.u);
-						hash_combine(h, va.uvw.v);
-						hash_combine(h, va.col.r);
-						hash_combine(h, va.col.g);
-						hash_combine(h, va.col.b);
-						hash_combine(h, va.col.a);
-						return h;
-					}
-				};
+			// redoing most of the corners costs about as much as a rebuild, which also gets rid of unused vertices
+			const size_t dirtyCount = (size_t)std::count(c._dirtyCorners.begin(), c._dirtyCorners.end(), (uint8_t)1);
+			if (dirtyCount * 2 > newCorners)
+			{
+				rebuildTetrahedralizeContext(c);
+				finish();
+				return true;
+			}
+
+			// removed tetrahedra
+			if (newCorners < oldCorners)
+			{
+				if (c._dedup == Dedup::None)
+				{
+					c._tuples.resize(newCorners);
+					c._references.resize(newCorners);
+					resizeContextOutputs(c, newCorners);
+				}
+				else
+					for (size_t corner = newCorners; corner < oldCorners; ++corner)
+						if (--c._references[c._indexBuffer[corner]] == 0)
+							c._unreferenced++;
+				c._indexBuffer.resize(newCorners);
+			}
 
-				std::unordered_map<HashVertData, uint32_t, hash> vertexMap;
-				std::vector<uint32_t> newIndexBuffer;
-				std::vector<fdo::Point> newPos;
-				std::vector<fdo::Point> newNorm;
-				std::vector<fdo::TexCoord> newUVW;
-				std::vector<fdo::Color> newCol;
-				newIndexBuffer.reserve(indexBuffer.size());
+			// vertices written by this update, turned into ranges at the end since revived vertices can be anywhere
+			c._changedVertexFlags.assign(c._tuples.size(), 0);
+			auto vertexChanged = [&](size_t vertex)
+				{
+					if (vertex >= c._changedVertexFlags.size())
+						c._changedVertexFlags.resize(vertex + 1, 0);
+					c._changedVertexFlags[vertex] = 1;
+				};
 
-				for (uint32_t ind : indexBuffer)
+			if (refetch && c._dedup == Dedup::ByIndex)
+			{
+				for (size_t v = 0; v < c._tuples.size(); ++v)
 				{
-					HashVertData v
+					// unused vertices can point past buffers that shrank since, they're fetched again if they come back
+					if (c._references[v] == 0)
+						continue;
+					const auto& t = c._tuples[v];
+					bool dirty = false;
+					for (size_t k = 0; k < 4; ++k)
+						dirty |= t[k] >= 0 && (size_t)t[k] < c._dirtyAttributes[k].size() && c._dirtyAttributes[k][t[k]] == 1;
+					if (dirty)
 					{
-						(pos ? pos->at(ind) : fdo::Point{0,0,0,0}),
-						(norm ? norm->at(ind) : fdo::Point{0,0,0,0}),
-						(uvw ? uvw->at(ind) : fdo::TexCoord{0,0,0}),
-						(col ? col->at(ind) : fdo::Color{0,0,0,0}),
-					};
-
-					auto it = vertexMap.find(v);
-					if (it != vertexMap.end())
+						fetchContextVertex(c, v);
+						vertexChanged(v);
+					}
+				}
+			}
+
+			const CornerKeys keys = cornerKeys(c._attributes, c._dedup);
+			for (size_t corner = 0; corner < newCorners; ++corner)
+			{
+				if (!c._dirtyCorners[corner])
+					continue;
+				const bool appended = corner >= c._indexBuffer.size();
+
+				if (c._dedup == Dedup::None)
+				{
+					if (appended)
 					{
-						newIndexBuffer.emplace_back(it->second);
+						c._indexBuffer.push_back((uint32_t)corner);
+						c._tuples.emplace_back();
+						c._references.push_back(1);
+						resizeContextOutputs(c, corner + 1);
+						TetrahedralizeContext::addChange(c._changedIndices, corner);
 					}
-					else
+					c._tuples[corner] = keys.indices((uint32_t)corner);
+					fetchContextVertex(c, corner);
+					vertexChanged(corner);
+					continue;
+				}
+
+				// put the corner's vertex at the end and look it up, keeping it only if it's new
+				const uint32_t candidate = (uint32_t)c._tuples.size();
+				c._tuples.push_back(keys.indices((uint32_t)corner));
+				resizeContextOutputs(c, candidate + 1);
+				fetchContextVertex(c, candidate);
+				bool inserted;
+				const uint32_t vertex = c._table.insert(candidate, TetrahedralizeContext::VertexKeys{ &c }(candidate), inserted);
+				if (inserted)
+				{
+					c._references.push_back(0);
+					vertexChanged(candidate);
+				}
+				else
+				{
+					c._tuples.pop_back();
+					resizeContextOutputs(c, candidate);
+					if (c._references[vertex] == 0)
 					{
-						uint32_t newInd = newPos.size();
-						if (pos)
-							newPos.emplace_back(v.pos);
-						if (norm)
-							newNorm.emplace_back(v.norm);
-						if (uvw)
-							newUVW.emplace_back(v.uvw);
-						if (col)
-							newCol.emplace_back(v.col);
-						vertexMap[v] = newInd;
-						newIndexBuffer.emplace_back(newInd);
+						// an unused vertex comes back, its indices may point to data that changed while nothing used it
+						c._unreferenced--;
+						if (c._dedup == Dedup::ByIndex)
+						{
+							fetchContextVertex(c, vertex);
+							vertexChanged(vertex);
+						}
 					}
 				}
 
-				indexBuffer = std::move(newIndexBuffer);
-				if (pos)
-					*pos = std::move(newPos);
-				if (norm)
-					*norm = std::move(newNorm);
-				if (uvw)
-					*uvw = std::move(newUVW);
-				if (col)
-					*col = std::move(newCol);
+				if (appended)
+					c._indexBuffer.push_back(vertex);
+				else if (c._indexBuffer[corner] != vertex)
+				{
+					if (--c._references[c._indexBuffer[corner]] == 0)
+						c._unreferenced++;
+					c._indexBuffer[corner] = vertex;
+				}
+				else
+					continue;
+				c._references[vertex]++;
+				TetrahedralizeContext::addChange(c._changedIndices, corner);
 			}
+
+			if (c._unreferenced > std::max<size_t>(1024, c._tuples.size() / 2))
+				rebuildTetrahedralizeContext(c);
+			else
+				for (size_t v = 0; v < c._changedVertexFlags.size(); ++v)
+					if (c._changedVertexFlags[v])
+						TetrahedralizeContext::addChange(c._changedVertices, v);
+			finish();
+			return true;
+		}
+
+		/**
+		 * Intersects the tetrahedra with the hyperplane `dot(normal, p) == offset`.
+		 * Every tetrahedron crossing it contributes a triangle or a quad (as 2 triangles), with the
+		 * requested attributes interpolated along the cut edges. The winding of the triangles isn't consistent.
+		 * For the usual `w = c` slice, use `normal = {0,0,0,1}` and `offset = c`.
+		 * @param normal The hyperplane normal. Doesn't have to be normalized.
+		 * @param offset The hyperplane offset along the normal.
+		 * @param out The output. Its buffers are reused, so pass the same one every frame to avoid allocations.
+		 * @param attributes Which attributes to interpolate. Positions are always written.
+		 */
+		void slice(const Point& normal, float offset, CrossSection& out, DataMask attributes = DataMask::All) const
+		{
+			out.clear();
+			if (tetrahedra.empty() || vertices.empty())
+				return;
+
+			computeSliceDistances(normal, offset, out);
+			sliceTetrahedra(nullptr, tetrahedra.size(), out.distances.data(), out.distances.size(), 0.f, out, attributes);
+		}
+		/**
+		 * Same as the other overload, but uses `index` to only visit the tetrahedra crossing the hyperplane.
+		 * Meant for sweeping the hyperplane along its normal: after the index is built (on first use, or after
+		 * the vertices or tetrahedra changed), moving to a new offset only costs as much as the tetrahedra
+		 * entering and leaving the cut. The hyperplane normal is the one of the index.
+		 * Unlike the other overload, the output isn't in tetrahedron order.
+		 * @param index The index to use. Gets (re)built if it doesn't match this Object anymore.
+		 * @param offset The hyperplane offset along the normal.
+		 * @param out The output. Its buffers are reused, so pass the same one every frame to avoid allocations.
+		 * @param attributes Which attributes to interpolate. Positions are always written.
+		 */
+		void slice(SliceIndex& index, float offset, CrossSection& out, DataMask attributes = DataMask::All) const
+		{
+			out.clear();
+			if (tetrahedra.empty() || vertices.empty())
+				return;
+
+			if (!index._built
+				|| index._verticesVersion != vertices.version() || index._verticesSize != vertices.size()
+				|| index._tetrahedraVersion != tetrahedra.version() || index._tetrahedraSize != tetrahedra.size())
+				buildSliceIndex(index, offset);
+			else
+				index.moveTo(offset);
+
+			sliceTetrahedra(index._active.data(), index._active.size(), index._projections.data(), index._projections.size(), offset, out, attributes);
+		}
+		/**
+		 * Same as the first overload, but only visits the tetrahedra of the cells that might cross the hyperplane (see cullCells).
+		 * Tetrahedra in no cell get skipped, tetrahedra in several cells are sliced once.
+		 * The output is in the order of the cells, then of their tetrahedra.
+		 * @param normal The hyperplane normal. Doesn't have to be normalized.
+		 * @param offset The hyperplane offset along the normal.
+		 * @param out The output. Its buffers are reused, so pass the same one every frame to avoid allocations.
+		 * @param attributes Which attributes to interpolate. Positions are always written.
+		 */
+		void sliceCells(const Point& normal, float offset, CrossSection& out, DataMask attributes = DataMask::All) const
+		{
+			out.clear();
+			if (tetrahedra.empty() || vertices.empty())
+				return;
+
+			cullCells(normal, offset, out.culled);
+
+			// only the vertices of the listed tetrahedra get a distance, the kernel doesn't look at the others
+			const float n[4] = { normal.x, normal.y, normal.z, normal.w };
+			const float* data = reinterpret_cast<const float*>(vertices.get().data());
+			const std::vector<Tetrahedron>& tets = tetrahedra.get();
+			const std::vector<Cell>& cellList = cells.get();
+			out.distances.resize(vertices.size());
+			out.tetrahedra.clear();
+			out.listed.resize(tets.size(), 0);
+			for (uint32_t c : out.culled.cells)
+				for (int32_t t : cellList[c].tIndices)
+					if (t >= 0 && (size_t)t < tets.size() && !out.listed[t])
+					{
+						out.listed[t] = 1;
+						out.tetrahedra.push_back((uint32_t)t);
+						for (int32_t v : tets[t].vIndices)
+							if (v >= 0 && (size_t)v < vertices.size())
+								simd::planeDistances4(data + (size_t)v * 4, 1, n, offset, out.distances.data() + v);
+					}
+			for (uint32_t t : out.tetrahedra)
+				out.listed[t] = 0;
+
+			sliceTetrahedra(out.tetrahedra.data(), out.tetrahedra.size(), out.distances.data(), out.distances.size(), 0.f, out, attributes);
+		}
+
+		/**
+		 * Interpolates the corner attributes of a tetrahedron, e.g. at a ray hit or a sampled point.
+		 * Attributes with invalid indices come out as zeros.
+		 * @param tetrahedron The tetrahedron index.
+		 * @param barycentrics The weights of its 4 corners.
+		 * @param normal The output normal (normalized). Can be left NULL if you don't need it.
+		 * @param texCoord The output texture coordinate. Can be left NULL if you don't need it.
+		 * @param color The output color. Can be left NULL if you don't need it.
+		 */
+		void interpolate(int32_t tetrahedron, const float (&barycentrics)[4], Point* normal, TexCoord* texCoord = nullptr, Color* color = nullptr) const
+		{
+			const std::vector<Tetrahedron>& tets = tetrahedra.get();
+			const bool validTet = tetrahedron >= 0 && tetrahedron < (int32_t)tets.size();
+			auto valid = [](const std::array<int32_t, 4>& ind, size_t size)
+				{
+					for (int i = 0; i < 4; i++)
+						if (ind[i] < 0 || ind[i] >= (int32_t)size)
+							return false;
+					return true;
+				};
+
+			if (normal)
+			{
+				const std::vector<Point>& norms = normals.get();
+				*normal = Point{ 0,0,0,0 };
+				if (validTet && valid(tets[tetrahedron].vnIndices, norms.size()))
+				{
+					for (int i = 0; i < 4; i++)
+						*normal += norms[tets[tetrahedron].vnIndices[i]] * barycentrics[i];
+					*normal = Point::normalize(*normal);
+				}
+			}
+			if (texCoord)
+			{
+				const std::vector<TexCoord>& uvws = texCoords.get();
+				*texCoord = TexCoord{ 0,0,0 };
+				if (validTet && valid(tets[tetrahedron].vtIndices, uvws.size()))
+					for (int i = 0; i < 4; i++)
+						*texCoord += uvws[tets[tetrahedron].vtIndices[i]] * barycentrics[i];
+			}
+			if (color)
+			{
+				const std::vector<Color>& cols = colors.get();
+				*color = Color{ 0,0,0,0 };
+				if (validTet && valid(tets[tetrahedron].coIndices, cols.size()))
+				{
+					float c[4]{};
+					for (int i = 0; i < 4; i++)
+					{
+						const Color& ci = cols[tets[tetrahedron].coIndices[i]];
+						c[0] += ci.r * barycentrics[i];
+						c[1] += ci.g * barycentrics[i];
+						c[2] += ci.b * barycentrics[i];
+						c[3] += ci.a * barycentrics[i];
+					}
+					auto channel = [](float v) { return std::clamp((int)std::lround(v), 0, 255); };
+					*color = Color{ channel(c[0]), channel(c[1]), channel(c[2]), channel(c[3]) };
+				}
+			}
+		}
+
+		// The amount of line segments in all polylines combined.
+		size_t polylineSegmentCount() const
+		{
+			size_t count = 0;
+			for (const Polyline& p : polylines.get())
+				count += p.vIndices.size() > 1 ? p.vIndices.size() - 1 : 0;
+			return count;
+		}
+
+		/**
+		 * Intersects every polyline segment with the hyperplane `dot(normal, p) == offset`.
+		 * Segments are treated the same way as tetrahedron edges in `slice`, so the points line up with its cross-sections.
+		 * For the usual `w = c` slice, the xyz of the resulting points are the 3D positions.
+		 * @param normal The hyperplane normal. Doesn't have to be normalized.
+		 * @param offset The hyperplane offset along the normal.
+		 * @param out The output points, in polyline order. Reuse it between calls to avoid allocations.
+		 */
+		void slicePolylines(const Point& normal, float offset, std::vector<Point>& out) const
+		{
+			out.clear();
+			const std::vector<Polyline>& lines = polylines.get();
+			if (lines.empty() || vertices.empty())
+				return;
+
+			const float n[4] = { normal.x, normal.y, normal.z, normal.w };
+			const size_t chunk = polylineChunkSize();
+			const size_t chunks = (lines.size() + chunk - 1) / chunk;
+
+			std::vector<size_t> chunkOffsets(chunks + 1, 0);
+			Parallel::forChunks(lines.size(), [&](size_t begin, size_t end)
+				{
+					size_t count = 0;
+					for (size_t i = begin; i < end; i++)
+						count += slicePolyline(lines[i], n, offset, nullptr);
+					chunkOffsets[begin / chunk + 1] = count;
+				}, chunk);
+			for (size_t i = 1; i <= chunks; i++)
+				chunkOffsets[i] += chunkOffsets[i - 1];
+
+			out.resize(chunkOffsets[chunks]);
+			Parallel::forChunks(lines.size(), [&](size_t begin, size_t end)
+				{
+					Point* dst = out.data() + chunkOffsets[begin / chunk];
+					for (size_t i = begin; i < end; i++)
+						dst += slicePolyline(lines[i], n, offset, dst);
+				}, chunk);
+		}
+
+		/**
+		 * Projects the polyline segments into 3D, as a line list: 2 vertices of 3 floats per segment, in polyline order.
+		 * Segment endpoints that don't point to a valid vertex end up at the origin.
+		 * @param out The output vertex buffer. Needs room for `polylineSegmentCount() * 6` floats.
+		 * @param mode Orthographic or perspective projection.
+		 * @param eyeW The w coordinate of the eye for perspective projection. Vertices at or beyond it don't project to anything meaningful.
+		 * @returns The amount of vertices written, or 0 if `out` is too small.
+		 */
+		size_t projectPolylines(std::span<float> out, ProjectionMode mode = ProjectionMode::Perspective, float eyeW = 2.f) const
+		{
+			const std::vector<Polyline>& lines = polylines.get();
+			const size_t segments = polylineSegmentCount();
+			if (out.size() < segments * 6)
+			{
+				Logger::logError(std::format("fdo::Object::projectPolylines: Output buffer is too small ({} floats for {} segments).", out.size(), segments));
+				return 0;
+			}
+			if (segments == 0)
+				return 0;
+
+			const size_t chunk = polylineChunkSize();
+			const size_t chunks = (lines.size() + chunk - 1) / chunk;
+
+			std::vector<size_t> chunkOffsets(chunks + 1, 0);
+			Parallel::forChunks(lines.size(), [&](size_t begin, size_t end)
+				{
+					size_t count = 0;
+					for (size_t i = begin; i < end; i++)
+						count += lines[i].vIndices.size() > 1 ? lines[i].vIndices.size() - 1 : 0;
+					chunkOffsets[begin / chunk + 1] = count;
+				}, chunk);
+			for (size_t i = 1; i <= chunks; i++)
+				chunkOffsets[i] += chunkOffsets[i - 1];
+
+			const bool perspective = mode == ProjectionMode::Perspective;
+			Parallel::forChunks(lines.size(), [&](size_t begin, size_t end)
+				{
+					// gather segment endpoints into a small batch, then project the whole batch straight into `out`
+					float batch[polylineBatchSize * 4];
+					size_t batchCount = 0;
+					float* dst = out.data() + chunkOffsets[begin / chunk] * 6;
+					auto flush = [&]()
+						{
+							simd::project3(batch, batchCount, perspective, eyeW, dst);
+							dst += batchCount * 3;
+							batchCount = 0;
+						};
+
+					for (size_t i = begin; i < end; i++)
+					{
+						const std::vector<int32_t>& ind = lines[i].vIndices;
+						for (size_t k = 1; k < ind.size(); k++)
+						{
+							gatherPolylineVertex(ind[k - 1], batch + batchCount++ * 4);
+							gatherPolylineVertex(ind[k], batch + batchCount++ * 4);
+							if (batchCount == polylineBatchSize)
+								flush();
+						}
+					}
+					flush();
+				}, chunk);
+
+			return segments * 2;
+		}
+
+	private:
+		inline static constexpr size_t polylineBatchSize = 64; // must be even
+
+		static size_t polylineChunkSize() { return std::max<size_t>(Parallel::getChunkSize() / 64, 1); }
+
+		// Copies vertex `ind` to `dst`, or zeros if the index is invalid. Returns whether it was valid.
+		bool gatherPolylineVertex(int32_t ind, float* dst) const
+		{
+			const std::vector<Point>& verts = vertices.get();
+			if (ind < 0 || ind >= (int32_t)verts.size())
+			{
+				dst[0] = dst[1] = dst[2] = dst[3] = 0.f;
+				return false;
+			}
+			std::memcpy(dst, &verts[ind], sizeof(Point));
+			return true;
+		}
+
+		/**
+		 * Writes the points where a polyline crosses the hyperplane `dot(n, p) == offset` to `out`.
+		 * Only counts them if `out` is null.
+		 * @returns The amount of points.
+		 */
+		uint32_t slicePolyline(const Polyline& line, const float (&n)[4], float offset, Point* out) const
+		{
+			const std::vector<int32_t>& ind = line.vIndices;
+			if (ind.size() < 2)
+				return 0;
+
+			Point points[polylineBatchSize];
+			float d[polylineBatchSize];
+			bool valid[polylineBatchSize];
+			uint32_t count = 0;
+
+			// runs of vertices overlap by one, so every segment lies within a run
+			for (size_t first = 0; first + 1 < ind.size(); first += polylineBatchSize - 1)
+			{
+				const size_t run = std::min(polylineBatchSize, ind.size() - first);
+				for (size_t k = 0; k < run; k++)
+					valid[k] = gatherPolylineVertex(ind[first + k], reinterpret_cast<float*>(&points[k]));
+				simd::planeDistances4(reinterpret_cast<const float*>(points), run, n, offset, d);
+
+				for (size_t k = 1; k < run; k++)
+				{
+					if (!valid[k - 1] || !valid[k] || (d[k - 1] > 0.f) == (d[k] > 0.f))
+						continue;
+					if (out)
+						out[count] = points[k - 1] + (points[k] - points[k - 1]) * (d[k - 1] / (d[k - 1] - d[k]));
+					count++;
+				}
+			}
+			return count;
+		}
+
+		// Projects every vertex and tetrahedron onto the index normal and sorts the tetrahedron ranges.
+		void buildSliceIndex(SliceIndex& index, float offset) const
+		{
+			const float n[4] = { index._normal.x, index._normal.y, index._normal.z, index._normal.w };
+			const float* data = reinterpret_cast<const float*>(vertices.get().data());
+			const std::vector<Tetrahedron>& tets = tetrahedra.get();
+
+			index._projections.resize(vertices.size());
+			Parallel::forChunks(vertices.size(), [&](size_t begin, size_t end)
+				{
+					simd::planeDistances4(data + begin * 4, end - begin, n, 0.f, index._projections.data() + begin);
+				});
+
+			index._min.resize(tets.size());
+			index._max.resize(tets.size());
+			Parallel::forChunks(tets.size(), [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; i++)
+					{
+						float lo = std::numeric_limits<float>::infinity();
+						float hi = -lo;
+						bool valid = true;
+						for (int j = 0; j < 4; j++)
+						{
+							int32_t v = tets[i].vIndices[j];
+							if (v < 0 || v >= (int32_t)index._projections.size())
+							{
+								valid = false;
+								break;
+							}
+							lo = std::min(lo, index._projections[v]);
+							hi = std::max(hi, index._projections[v]);
+						}
+						// an empty range never crosses anything
+						index._min[i] = valid ? lo : std::numeric_limits<float>::infinity();
+						index._max[i] = valid ? hi : -std::numeric_limits<float>::infinity();
+					}
+				});
+
+			index.finishBuild(offset);
+			index._verticesVersion = vertices.version();
+			index._verticesSize = vertices.size();
+			index._tetrahedraVersion = tetrahedra.version();
+			index._tetrahedraSize = tets.size();
+		}
+
+		// Lists the cells whose cached bounds pass `test`, in parallel and in ascending order.
+		template<typename F>
+		void cullCellsWhere(CulledCells& out, F&& test) const
+		{
+			std::lock_guard lock(_cellBoundsCache.mutex);
+			const std::vector<CellBounds>& bounds = updateCellBoundsCache();
+
+			const size_t chunk = std::max<size_t>(Parallel::getChunkSize() / 4, 1);
+			const size_t chunks = (bounds.size() + chunk - 1) / chunk;
+			std::vector<size_t>& chunkOffsets = out.chunkOffsets;
+			chunkOffsets.assign(chunks + 1, 0);
+			Parallel::forChunks(bounds.size(), [&](size_t begin, size_t end)
+				{
+					size_t count = 0;
+					for (size_t c = begin; c < end; c++)
+						count += test(bounds[c]);
+					chunkOffsets[begin / chunk + 1] = count;
+				}, chunk);
+			for (size_t i = 1; i <= chunks; i++)
+				chunkOffsets[i] += chunkOffsets[i - 1];
+
+			out.cells.resize(chunkOffsets[chunks]);
+			Parallel::forChunks(bounds.size(), [&](size_t begin, size_t end)
+				{
+					uint32_t* dst = out.cells.data() + chunkOffsets[begin / chunk];
+					for (size_t c = begin; c < end; c++)
+						if (test(bounds[c]))
+							*dst++ = (uint32_t)c;
+				}, chunk);
+		}
+
+		/**
+		 * Slices the tetrahedra `list[0..count)` (or the first `count` tetrahedra if `list` is null), in list order.
+		 * The signed distance of vertex `v` is `projections[v] - offset`.
+		 */
+		void sliceTetrahedra(const uint32_t* list, size_t count, const float* projections, size_t projectionCount, float offset, CrossSection& out, DataMask attributes) const
+		{
+			const std::vector<Tetrahedron>& tets = tetrahedra.get();
+			const size_t chunk = std::max<size_t>(Parallel::getChunkSize() / 4, 1);
+			const size_t chunks = (count + chunk - 1) / chunk;
+			auto tetAt = [&](size_t i) { return list ? (size_t)list[i] : i; };
+
+			// count the output of every chunk first, so all of them can be written in parallel, in list order
+			out.chunkOffsets.assign(chunks + 1, { 0, 0 });
+			Parallel::forChunks(count, [&](size_t begin, size_t end)
+				{
+					size_t verts = 0;
+					size_t tris = 0;
+					for (size_t i = begin; i < end; i++)
+					{
+						uint32_t n = sliceVertexCount(tets[tetAt(i)], projections, projectionCount, offset);
+						verts += n;
+						tris += n ? n - 2 : 0;
+					}
+					out.chunkOffsets[begin / chunk + 1] = { verts, tris };
+				}, chunk);
+			for (size_t i = 1; i <= chunks; i++)
+			{
+				out.chunkOffsets[i].first += out.chunkOffsets[i - 1].first;
+				out.chunkOffsets[i].second += out.chunkOffsets[i - 1].second;
+			}
+
+			resizeSliceOutput(out, out.chunkOffsets[chunks].first, out.chunkOffsets[chunks].second, attributes);
+
+			Parallel::forChunks(count, [&](size_t begin, size_t end)
+				{
+					auto [vert, tri] = out.chunkOffsets[begin / chunk];
+					for (size_t i = begin; i < end; i++)
+					{
+						size_t t = tetAt(i);
+						uint32_t n = emitSlice(tets[t], (int32_t)t, projections, projectionCount, offset, out, vert, tri, attributes);
+						vert += n;
+						tri += n ? n - 2 : 0;
+					}
+				}, chunk);
+		}
+
+		// Fills `out.distances` with the signed distance of every vertex to the hyperplane.
+		void computeSliceDistances(const Point& normal, float offset, CrossSection& out) const
+		{
+			const float n[4] = { normal.x, normal.y, normal.z, normal.w };
+			const float* data = reinterpret_cast<const float*>(vertices.get().data());
+
+			out.distances.resize(vertices.size());
+			Parallel::forChunks(vertices.size(), [&](size_t begin, size_t end)
+				{
+					simd::planeDistances4(data + begin * 4, end - begin, n, offset, out.distances.data() + begin);
+				});
+		}
+
+		// Returns the amount of cross-section vertices a tetrahedron produces: 0, 3 (triangle) or 4 (quad).
+		static uint32_t sliceVertexCount(const Tetrahedron& tet, const float* projections, size_t projectionCount, float offset)
+		{
+			uint32_t above = 0;
+			for (int i = 0; i < 4; i++)
+			{
+				int32_t v = tet.vIndices[i];
+				if (v < 0 || v >= (int32_t)projectionCount)
+					return 0;
+				above += projections[v] - offset > 0.f;
+			}
+			if (above == 0 || above == 4) return 0;
+			return above == 2 ? 4 : 3;
+		}
+
+		// Makes room for `vertexCount` cross-section vertices and `triangleCount` triangles.
+		static void resizeSliceOutput(CrossSection& out, size_t vertexCount, size_t triangleCount, DataMask attributes)
+		{
+			out.indices.resize(triangleCount * 3);
+			out.triangleTetrahedra.resize(triangleCount);
+			out.positions.resize(vertexCount);
+			if (hasData(attributes, FDataType::vn))
+				out.normals.resize(vertexCount);
+			if (hasData(attributes, FDataType::vt))
+				out.texCoords.resize(vertexCount);
+			if (hasData(attributes, FDataType::co))
+				out.colors.resize(vertexCount);
+		}
+
+		/**
+		 * Writes the cross-section of one tetrahedron, starting at vertex `firstVertex` and triangle `firstTriangle`.
+		 * A triangle takes 3 vertices, a quad takes 4 vertices and 2 triangles.
+		 * @returns The amount of vertices written.
+		 */
+		uint32_t emitSlice(const Tetrahedron& tet, int32_t tetIndex, const float* projections, size_t projectionCount, float offset, CrossSection& out, size_t firstVertex, size_t firstTriangle, DataMask attributes) const
+		{
+			uint32_t count = sliceVertexCount(tet, projections, projectionCount, offset);
+			if (count == 0)
+				return 0;
+
+			const uint32_t v0 = (uint32_t)firstVertex;
+			uint32_t* ind = out.indices.data() + firstTriangle * 3;
+			ind[0] = v0; ind[1] = v0 + 1; ind[2] = v0 + 2;
+			out.triangleTetrahedra[firstTriangle] = tetIndex;
+			if (count == 4)
+			{
+				ind[3] = v0; ind[4] = v0 + 2; ind[5] = v0 + 3;
+				out.triangleTetrahedra[firstTriangle + 1] = tetIndex;
+			}
+
+			float d[4];
+			int above[4], below[4];
+			int aboveCount = 0, belowCount = 0;
+			for (int i = 0; i < 4; i++)
+			{
+				d[i] = projections[tet.vIndices[i]] - offset;
+				if (d[i] > 0.f)
+					above[aboveCount++] = i;
+				else
+					below[belowCount++] = i;
+			}
+
+			// the cut edges, in an order that walks around the resulting polygon
+			std::pair<int, int> edges[4];
+			if (aboveCount == 1)
+				edges[0] = { above[0], below[0] }, edges[1] = { above[0], below[1] }, edges[2] = { above[0], below[2] };
+			else if (belowCount == 1)
+				edges[0] = { above[0], below[0] }, edges[1] = { above[1], below[0] }, edges[2] = { above[2], below[0] };
+			else
+				edges[0] = { above[0], below[0] }, edges[1] = { above[0], below[1] }, edges[2] = { above[1], below[1] }, edges[3] = { above[1], below[0] };
+
+			const std::vector<Point>& verts = vertices.get();
+			const std::vector<Point>& norms = normals.get();
+			const std::vector<TexCoord>& uvws = texCoords.get();
+			const std::vector<Color>& cols = colors.get();
+
+			auto valid = [](int32_t ind, size_t size) { return ind >= 0 && ind < (int32_t)size; };
+
+			for (uint32_t e = 0; e < count; e++)
+			{
+				const int a = edges[e].first;
+				const int b = edges[e].second;
+				// d[a] > 0 >= d[b], so the denominator is never 0
+				const float t = d[a] / (d[a] - d[b]);
+				const size_t o = firstVertex + e;
+
+				out.positions[o] = verts[tet.vIndices[a]] + (verts[tet.vIndices[b]] - verts[tet.vIndices[a]]) * t;
+
+				if (hasData(attributes, FDataType::vn))
+				{
+					int32_t na = tet.vnIndices[a], nb = tet.vnIndices[b];
+					out.normals[o] = valid(na, norms.size()) && valid(nb, norms.size())
+						? Point::normalize(norms[na] + (norms[nb] - norms[na]) * t)
+						: Point{ 0,0,0,0 };
+				}
+				if (hasData(attributes, FDataType::vt))
+				{
+					int32_t ta = tet.vtIndices[a], tb = tet.vtIndices[b];
+					out.texCoords[o] = valid(ta, uvws.size()) && valid(tb, uvws.size())
+						? uvws[ta] + (uvws[tb] - uvws[ta]) * t
+						: TexCoord{ 0,0,0 };
+				}
+				if (hasData(attributes, FDataType::co))
+				{
+					int32_t ca = tet.coIndices[a], cb = tet.coIndices[b];
+					if (valid(ca, cols.size()) && valid(cb, cols.size()))
+					{
+						const Color& c0 = cols[ca];
+						const Color& c1 = cols[cb];
+						auto lerp = [t](uint8_t x, uint8_t y) { return (int)std::lround(x + (y - x) * t); };
+						out.colors[o] = Color{ lerp(c0.r, c1.r), lerp(c0.g, c1.g), lerp(c0.b, c1.b), lerp(c0.a, c1.a) };
+					}
+					else
+						out.colors[o] = Color{ 0,0,0,0 };
+				}
+			}
+
+			return count;
+		}
+
+		// The CornerKeys of this Object's tetrahedra.
+		CornerKeys cornerKeys(DataMask attributes, Dedup dedup) const
+		{
+			return CornerKeys(tetrahedra.get(), vertices.get(), normals.get(), texCoords.get(), colors.get(), attributes, dedup);
+		}
+
+		/**
+		 * Merges the corners of the tetrahedra into vertices, see tetrahedralize. Vertices are numbered in the order they're first seen.
+		 * Chunks of corners get merged in parallel, then combined in order, so the result doesn't depend on the thread count.
+		 * @param scratch Gets the first corner of every vertex, in `_corners`.
+		 * @param indexBuffer The vertex of every corner.
+		 */
+		void mergeCorners(TetrahedralizeScratch& scratch, std::vector<uint32_t>& indexBuffer, DataMask attributes, Dedup dedup) const
+		{
+			mergeCorners(scratch, indexBuffer, cornerKeys(attributes, dedup), tetrahedra.size() * 4, dedup);
+		}
+		// Merges the corners [0, cornerCount) told apart by `keys`.
+		void mergeCorners(TetrahedralizeScratch& scratch, std::vector<uint32_t>& indexBuffer, const CornerKeys& keys, size_t cornerCount, Dedup dedup) const
+		{
+			std::vector<uint32_t>& corners = scratch._corners;
+			indexBuffer.resize(cornerCount);
+
+			if (dedup == Dedup::None)
+			{
+				corners.resize(cornerCount);
+				for (uint32_t i = 0; i < cornerCount; ++i)
+					indexBuffer[i] = corners[i] = i;
+				return;
+			}
+
+			auto& vertexMap = scratch._table;
+			vertexMap.setFunctions(keys, keys);
+			vertexMap.clear();
+			vertexMap.reserve(cornerCount);
+
+			const size_t chunk = Parallel::getChunkSize();
+			const size_t chunkCount = (cornerCount + chunk - 1) / chunk;
+			if (chunkCount <= 1 || Parallel::getThreadCount() == 1)
+			{
+				for (uint32_t i = 0; i < cornerCount; ++i)
+					indexBuffer[i] = vertexMap.insert(i);
+				corners = vertexMap.keys();
+				return;
+			}
+
+			// merge every chunk on its own, indexBuffer gets chunk-local vertex indices
+			if (scratch._locals.size() < chunkCount)
+				scratch._locals.resize(chunkCount);
+			Parallel::forChunks(cornerCount, [&](size_t begin, size_t end)
+				{
+					auto& localMap = scratch._locals[begin / chunk].table;
+					localMap.setFunctions(keys, keys);
+					localMap.clear();
+					localMap.reserve(end - begin);
+					for (size_t i = begin; i < end; ++i)
+						indexBuffer[i] = localMap.insert((uint32_t)i);
+				}, chunk);
+
+			// add the local vertices to one table in chunk order, which numbers them exactly like a serial pass would,
+			// reusing the hashes and building a local -> global index map for every chunk
+			for (size_t c = 0; c < chunkCount; ++c)
+			{
+				TetrahedralizeScratch::Local& local = scratch._locals[c];
+				const std::vector<uint32_t>& localCorners = local.table.keys();
+				const std::vector<uint64_t>& localHashes = local.table.hashes();
+				local.toGlobal.resize(localCorners.size());
+				for (size_t i = 0; i < localCorners.size(); ++i)
+				{
+					bool inserted;
+					local.toGlobal[i] = vertexMap.insert(localCorners[i], localHashes[i], inserted);
+				}
+			}
+			corners = vertexMap.keys();
+
+			Parallel::forChunks(cornerCount, [&](size_t begin, size_t end)
+				{
+					const std::vector<uint32_t>& toGlobal = scratch._locals[begin / chunk].toGlobal;
+					for (size_t i = begin; i < end; ++i)
+						indexBuffer[i] = toGlobal[indexBuffer[i]];
+				}, chunk);
+		}
+
+		// Copies the data of tetrahedron corner `corner` to the outputs that aren't NULL, using zeroes for missing data.
+		void fetchCorner(uint32_t corner, Point* pos, Point* norm, TexCoord* uvw, Color* col) const
+		{
+			const Tetrahedron& tet = tetrahedra.get()[corner / 4];
+			const int vertex = corner % 4;
+			if (pos)
+			{
+				auto v = tet.vIndices[vertex];
+				*pos = v >= 0 && (size_t)v < vertices.size() ? vertices[v] : Point{ 0,0,0,0 };
+			}
+			if (norm)
+			{
+				auto vn = tet.vnIndices[vertex];
+				*norm = vn >= 0 && (size_t)vn < normals.size() ? normals[vn] : Point{ 0,0,0,0 };
+			}
+			if (uvw)
+			{
+				auto vt = tet.vtIndices[vertex];
+				*uvw = vt >= 0 && (size_t)vt < texCoords.size() ? texCoords[vt] : TexCoord{ 0,0,0 };
+			}
+			if (col)
+			{
+				auto co = tet.coIndices[vertex];
+				*col = co >= 0 && (size_t)co < colors.size() ? colors[co] : Color{ 0,0,0,0 };
+			}
+		}
+
+		/**
+		 * Flattens the polylines into `scratch` and merges their points into vertices, see linearize.
+		 * @param scratch Gets the first point of every vertex, in `_corners`.
+		 * @param indexBuffer 2 vertex indices per segment.
+		 */
+		void mergeLinePoints(TetrahedralizeScratch& scratch, std::vector<uint32_t>& indexBuffer, DataMask attributes, Dedup dedup) const
+		{
+			const std::vector<Polyline>& lines = polylines.get();
+			std::vector<uint32_t>& pointOffsets = scratch._pointOffsets;
+			std::vector<uint32_t>& segmentOffsets = scratch._segmentOffsets;
+			pointOffsets.resize(lines.size() + 1);
+			segmentOffsets.resize(lines.size() + 1);
+			pointOffsets[0] = segmentOffsets[0] = 0;
+			for (size_t i = 0; i < lines.size(); ++i)
+			{
+				const size_t length = lines[i].vIndices.size() > 1 ? lines[i].vIndices.size() : 0;
+				pointOffsets[i + 1] = pointOffsets[i] + (uint32_t)length;
+				segmentOffsets[i + 1] = segmentOffsets[i] + (uint32_t)(length > 0 ? length - 1 : 0);
+			}
+
+			// same checks as CornerKeys::indices, done once per point
+			CornerKeys keys = CornerKeys({}, vertices.get(), normals.get(), texCoords.get(), colors.get(), attributes, dedup);
+			std::vector<std::array<int32_t, 4>>& points = scratch._points;
+			points.resize(pointOffsets.back());
+			const size_t chunk = polylineChunkSize();
+			Parallel::forChunks(lines.size(), [&](size_t begin, size_t end)
+				{
+					auto checked = [](const std::vector<int32_t>& indices, size_t k, size_t size) -> int32_t
+						{
+							return k < indices.size() && indices[k] >= 0 && (size_t)indices[k] < size ? indices[k] : -1;
+						};
+					for (size_t i = begin; i < end; ++i)
+					{
+						const Polyline& line = lines[i];
+						for (uint32_t k = 0; k < pointOffsets[i + 1] - pointOffsets[i]; ++k)
+							points[pointOffsets[i] + k] =
+							{
+								checked(line.vIndices, k, keys.verts.size()),
+								checked(line.vnIndices, k, keys.norms.size()),
+								checked(line.vtIndices, k, keys.uvws.size()),
+								checked(line.coIndices, k, keys.cols.size()),
+							};
+					}
+				}, chunk);
+			keys.points = points.data();
+
+			std::vector<uint32_t>& pointVertices = scratch._pointVertices;
+			mergeCorners(scratch, pointVertices, keys, points.size(), dedup);
+
+			// every segment joins 2 consecutive points of a polyline
+			indexBuffer.resize((size_t)segmentOffsets.back() * 2);
+			Parallel::forChunks(lines.size(), [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++i)
+					{
+						const uint32_t* vertex = pointVertices.data() + pointOffsets[i];
+						uint32_t* out = indexBuffer.data() + (size_t)segmentOffsets[i] * 2;
+						for (uint32_t k = 0; k < segmentOffsets[i + 1] - segmentOffsets[i]; ++k)
+						{
+							out[k * 2] = vertex[k];
+							out[k * 2 + 1] = vertex[k + 1];
+						}
+					}
+				}, chunk);
+		}
+
+		// Copies the data of a polyline point (indices as in TetrahedralizeScratch::_points) to the outputs that aren't NULL, using zeroes for missing data.
+		void fetchLinePoint(const std::array<int32_t, 4>& point, Point* pos, Point* norm, TexCoord* uvw, Color* col) const
+		{
+			if (pos)
+				*pos = point[0] >= 0 ? vertices[point[0]] : Point{ 0,0,0,0 };
+			if (norm)
+				*norm = point[1] >= 0 ? normals[point[1]] : Point{ 0,0,0,0 };
+			if (uvw)
+				*uvw = point[2] >= 0 ? texCoords[point[2]] : TexCoord{ 0,0,0 };
+			if (col)
+				*col = point[3] >= 0 ? colors[point[3]] : Color{ 0,0,0,0 };
+		}
+
+		/**
+		 * Fills in the TetrahedralizeInfo for the merged vertices in `scratch` (`_corners`, indices in `_indexBuffer`),
+		 * and writes them to the caller's buffers if they fit.
+		 * @param function The name of the public function, for errors.
+		 * @param fetch Reads the data of a corner, see writeVertices.
+		 */
+		template<typename F>
+		TetrahedralizeInfo writeBuffers(const char* function, const TetrahedralizeScratch& scratch, const VertexLayout& layout, std::span<std::byte> vertexData, std::span<std::byte> indexData, IndexFormat indexFormat, F&& fetch) const
+		{
+			const std::vector<uint32_t>& indexBuffer = scratch._indexBuffer;
+			const std::vector<uint32_t>& corners = scratch._corners;
+
+			TetrahedralizeInfo info;
+			const bool fits16 = corners.size() <= 65536;
+			info.vertexCount = corners.size();
+			info.indexCount = indexBuffer.size();
+			info.indexFormat = indexFormat == IndexFormat::Auto ? (fits16 ? IndexFormat::UInt16 : IndexFormat::UInt32) : indexFormat;
+			info.vertexBytes = layout.bytes(corners.size());
+			info.indexBytes = indexBuffer.size() * (info.indexFormat == IndexFormat::UInt16 ? 2 : 4);
+
+			if (info.indexFormat == IndexFormat::UInt16 && !fits16)
+			{
+				Logger::logError(std::format("fdo::Object::{}: {} vertices don't fit 16-bit indices.", function, corners.size()));
+				return info;
+			}
+			if (info.vertexBytes > vertexData.size() || info.indexBytes > indexData.size())
+				return info;
+
+			writeVertices(corners, layout, vertexData.data(), fetch);
+			encodeIndices(indexBuffer, info.indexFormat, indexData.data());
+			info.written = true;
+			return info;
+		}
+
+		// Resizes the outputs that aren't NULL to one element per vertex and fills them in, reading the data of a corner with `fetch` (like fetchCorner).
+		template<typename F>
+		static void fetchVertices(const std::vector<uint32_t>& corners, std::vector<Point>* pos, std::vector<Point>* norm, std::vector<TexCoord>* uvw, std::vector<Color>* col, F&& fetch)
+		{
+			// corners with missing/out-of-bounds data get zeroes, so every output stays aligned with the index buffer
+			if (pos)
+				pos->resize(corners.size());
+			if (norm)
+				norm->resize(corners.size());
+			if (uvw)
+				uvw->resize(corners.size());
+			if (col)
+				col->resize(corners.size());
+
+			Parallel::forChunks(corners.size(), [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++i)
+						fetch(corners[i],
+							pos ? &(*pos)[i] : nullptr,
+							norm ? &(*norm)[i] : nullptr,
+							uvw ? &(*uvw)[i] : nullptr,
+							col ? &(*col)[i] : nullptr);
+				});
+		}
+
+		// Grows `bounds` by the valid vertex positions of tetrahedron `t`.
+		void expandTetrahedron(AABB4& bounds, uint32_t t) const
+		{
+			const Tetrahedron& tet = tetrahedra.get()[t];
+			const std::vector<Point>& verts = vertices.get();
+			for (int k = 0; k < 4; ++k)
+				if (tet.vIndices[k] >= 0 && (size_t)tet.vIndices[k] < verts.size())
+					bounds.expand(verts[tet.vIndices[k]]);
+		}
+
+		// Splits every range of `indexBuffer` (written by tetrahedralizeCells, its tetrahedra in `scratch._cellTetrahedra`) into tetlets.
+		void buildTetlets(Tetlets& out, TetrahedralizeScratch& scratch, const std::vector<uint32_t>& indexBuffer, const std::vector<DrawRange>& ranges) const
+		{
+			if (out.maxVertices < 4 || out.maxVertices > 256 || out.maxTetrahedra == 0)
+			{
+				Logger::logError(std::format("fdo::Object::tetrahedralizeCells: Invalid tetlet limits ({} vertices, {} tetrahedra), clamping.", out.maxVertices, out.maxTetrahedra));
+				out.maxVertices = std::clamp<uint32_t>(out.maxVertices, 4, 256);
+				out.maxTetrahedra = std::max<uint32_t>(out.maxTetrahedra, 1);
+			}
+
+			const std::vector<uint32_t>& order = scratch._cellTetrahedra;
+			out.tetlets.clear();
+			out.vertices.clear();
+			out.indices.resize(indexBuffer.size());
+
+			// a vertex is in the current tetlet if it was added at or after the tetlet's first vertex
+			constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+			std::vector<uint32_t>& slots = scratch._tetletSlots;
+			slots.assign(scratch._corners.size(), none);
+			auto contains = [&](const Tetlet& tetlet, uint32_t v) { return slots[v] != none && slots[v] >= tetlet.firstVertex; };
+
+			for (uint32_t r = 0; r < ranges.size(); ++r)
+			{
+				const uint32_t first = ranges[r].firstIndex;
+				const uint32_t end = first + ranges[r].indexCount;
+				Tetlet tetlet{ first, 0, (uint32_t)out.vertices.size(), 0, r, {} };
+				for (uint32_t i = first; i < end; i += 4)
+				{
+					uint32_t added = 0;
+					for (uint32_t k = 0; k < 4; ++k)
+					{
+						const uint32_t v = indexBuffer[i + k];
+						bool repeated = contains(tetlet, v);
+						for (uint32_t j = 0; j < k && !repeated; ++j)
+							repeated = indexBuffer[i + j] == v;
+						added += !repeated;
+					}
+					if (tetlet.indexCount > 0 && (tetlet.indexCount / 4 == out.maxTetrahedra || tetlet.vertexCount + added > out.maxVertices))
+					{
+						out.tetlets.push_back(tetlet);
+						tetlet = { i, 0, (uint32_t)out.vertices.size(), 0, r, {} };
+					}
+
+					for (uint32_t k = 0; k < 4; ++k)
+					{
+						const uint32_t v = indexBuffer[i + k];
+						if (!contains(tetlet, v))
+						{
+							slots[v] = (uint32_t)out.vertices.size();
+							out.vertices.push_back(v);
+							tetlet.vertexCount++;
+						}
+						out.indices[i + k] = (uint8_t)(slots[v] - tetlet.firstVertex);
+					}
+					tetlet.indexCount += 4;
+					expandTetrahedron(tetlet.bounds, order[i / 4]);
+				}
+				if (tetlet.indexCount > 0)
+					out.tetlets.push_back(tetlet);
+			}
+		}
+
+		// The version and size of every buffer a TetrahedralizeContext depends on, in its order.
+		void tetrahedralizeState(uint64_t (&versions)[TetrahedralizeContext::bufferCount], size_t (&sizes)[TetrahedralizeContext::bufferCount]) const
+		{
+			versions[0] = tetrahedra.version(); sizes[0] = tetrahedra.size();
+			versions[1] = vertices.version(); sizes[1] = vertices.size();
+			versions[2] = normals.version(); sizes[2] = normals.size();
+			versions[3] = texCoords.version(); sizes[3] = texCoords.size();
+			versions[4] = colors.version(); sizes[4] = colors.size();
+		}
+
+		// Resizes the requested outputs of `context` to `count` vertices, and clears the others.
+		static void resizeContextOutputs(TetrahedralizeContext& context, size_t count)
+		{
+			auto resize = [&](auto& output, FDataType type) { output.resize(hasData(context._attributes, type) ? count : 0); };
+			resize(context._positions, FDataType::v);
+			resize(context._normals, FDataType::vn);
+			resize(context._texCoords, FDataType::vt);
+			resize(context._colors, FDataType::co);
+		}
+
+		// Writes the outputs of vertex `vertex` in `context` from its attribute indices.
+		void fetchContextVertex(TetrahedralizeContext& context, size_t vertex) const
+		{
+			// indices past the current buffers count as missing
+			const std::array<int32_t, 4>& t = context._tuples[vertex];
+			if (!context._positions.empty())
+				context._positions[vertex] = t[0] >= 0 && (size_t)t[0] < vertices.size() ? vertices[t[0]] : Point{ 0,0,0,0 };
+			if (!context._normals.empty())
+				context._normals[vertex] = t[1] >= 0 && (size_t)t[1] < normals.size() ? normals[t[1]] : Point{ 0,0,0,0 };
+			if (!context._texCoords.empty())
+				context._texCoords[vertex] = t[2] >= 0 && (size_t)t[2] < texCoords.size() ? texCoords[t[2]] : TexCoord{ 0,0,0 };
+			if (!context._colors.empty())
+				context._colors[vertex] = t[3] >= 0 && (size_t)t[3] < colors.size() ? colors[t[3]] : Color{ 0,0,0,0 };
+		}
+
+		// Whether `corner` still belongs to the vertex `context` has for it, as long as the attribute data it uses didn't change.
+		bool contextCornerMatches(const TetrahedralizeContext& context, const CornerKeys& keys, size_t corner) const
+		{
+			const uint32_t vertex = context._indexBuffer[corner];
+			const std::array<int32_t, 4> t = keys.indices((uint32_t)corner);
+			if (t == context._tuples[vertex])
+				return true;
+			if (context._dedup != Dedup::ByValue)
+				return false;
+			// corners merged by value can use other indices than the vertex was made from
+			return (context._positions.empty() || (t[0] >= 0 ? vertices[t[0]] : Point{ 0,0,0,0 }) == context._positions[vertex])
+				&& (context._normals.empty() || (t[1] >= 0 ? normals[t[1]] : Point{ 0,0,0,0 }) == context._normals[vertex])
+				&& (context._texCoords.empty() || (t[2] >= 0 ? texCoords[t[2]] : TexCoord{ 0,0,0 }) == context._texCoords[vertex])
+				&& (context._colors.empty() || (t[3] >= 0 ? colors[t[3]] : Color{ 0,0,0,0 }) == context._colors[vertex]);
+		}
+
+		// Redoes everything in `context`, like the other tetrahedralize overloads do.
+		void rebuildTetrahedralizeContext(TetrahedralizeContext& context) const
+		{
+			TetrahedralizeContext& c = context;
+			mergeCorners(c._scratch, c._indexBuffer, c._attributes, c._dedup);
+
+			const std::vector<uint32_t>& corners = c._scratch._corners;
+			const size_t count = corners.size();
+			const CornerKeys keys = cornerKeys(c._attributes, c._dedup);
+			c._tuples.resize(count);
+			resizeContextOutputs(c, count);
+			Parallel::forChunks(count, [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++i)
+					{
+						c._tuples[i] = keys.indices(corners[i]);
+						fetchContextVertex(c, i);
+					}
+				});
+
+			c._references.assign(count, 0);
+			for (uint32_t vertex : c._indexBuffer)
+				c._references[vertex]++;
+			c._unreferenced = 0;
+
+			// every vertex is unique already, only the table needs filling
+			c._table.clear();
+			if (c._dedup != Dedup::None)
+			{
+				c._table.reserve(count);
+				const TetrahedralizeContext::VertexKeys vertexKeys{ &c };
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					bool inserted;
+					c._table.insert(i, vertexKeys(i), inserted);
+				}
+			}
+
+			c._built = true;
+			c._rebuilt = true;
+			c._changedIndices.clear();
+			c._changedVertices.clear();
+			if (!c._indexBuffer.empty())
+				c._changedIndices.push_back({ 0, c._indexBuffer.size() });
+			if (count > 0)
+				c._changedVertices.push_back({ 0, count });
+		}
+
+		inline static constexpr size_t vertexBatchSize = 64;
+
+		// Writes the vertices starting at the given tetrahedron corners to `dst`, laid out as described by `layout`.
+		void writeVertices(const std::vector<uint32_t>& corners, const VertexLayout& layout, std::byte* dst) const
+		{
+			writeVertices(corners, layout, dst, [this](uint32_t corner, Point* pos, Point* norm, TexCoord* uvw, Color* col)
+				{
+					fetchCorner(corner, pos, norm, uvw, col);
+				});
+		}
+		// Same as above, with `fetch(corner, pos, norm, uvw, col)` reading the data of a corner like fetchCorner does.
+		template<typename F>
+		void writeVertices(const std::vector<uint32_t>& corners, const VertexLayout& layout, std::byte* dst, F&& fetch) const
+		{
+			Parallel::forChunks(corners.size(), [&](size_t begin, size_t end)
+				{
+					// gather every attribute as 4 floats per vertex, then encode a whole batch at once
+					float batch[vertexBatchSize * 4];
+					for (size_t first = begin; first < end; first += vertexBatchSize)
+					{
+						const size_t n = std::min(vertexBatchSize, end - first);
+						for (const VertexAttribute& attribute : layout.attributes)
+						{
+							for (size_t i = 0; i < n; ++i)
+							{
+								float* out = batch + i * 4;
+								switch (attribute.type)
+								{
+								case FDataType::v:
+								case FDataType::vn:
+								{
+									Point p;
+									fetch(corners[first + i], attribute.type == FDataType::v ? &p : nullptr, attribute.type == FDataType::vn ? &p : nullptr, nullptr, nullptr);
+									out[0] = p.x; out[1] = p.y; out[2] = p.z; out[3] = p.w;
+									break;
+								}
+								case FDataType::vt:
+								{
+									TexCoord uvw;
+									fetch(corners[first + i], nullptr, nullptr, &uvw, nullptr);
+									out[0] = uvw.u; out[1] = uvw.v; out[2] = uvw.w; out[3] = 0.f;
+									break;
+								}
+								case FDataType::co:
+								{
+									Color c;
+									fetch(corners[first + i], nullptr, nullptr, nullptr, &c);
+									out[0] = c.r / 255.f; out[1] = c.g / 255.f; out[2] = c.b / 255.f; out[3] = c.a / 255.f;
+									break;
+								}
+								default:
+									out[0] = out[1] = out[2] = out[3] = 0.f;
+									break;
+								}
+							}
+							encodeVertexFormat(attribute.format, batch, n, dst + first * layout.stride + attribute.offset, layout.stride);
+						}
+					}
+				}, Parallel::getChunkSize() / 4);
 		}
 	};
 }
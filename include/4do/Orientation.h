@@ -96,5 +96,16 @@ namespace fdo
 				result[to.getInd(i)] = point[from.getInd(i)] * from.getSign(i) * to.getSign(i);
 			return result;
 		}
+
+		/**
+		 * Builds the matrix doing the same thing as `transform(point, from, to)`.
+		 * @param m The output column-major 4x4 matrix.
+		 */
+		inline static void transformMatrix(const Orientation& from, const Orientation& to, float (&m)[16])
+		{
+			std::fill(std::begin(m), std::end(m), 0.f);
+			for(size_t i = 0; i < 4; i++)
+				m[from.getInd(i) * 4 + to.getInd(i)] = from.getSign(i) * to.getSign(i);
+		}
 	};
 }
@@ -0,0 +1,321 @@
+#pragma once
+
+#include "basicIncludes.h"
+
+namespace fdo
+{
+	/**
+	 * A minimal pool of worker threads running chunked jobs.
+	 * The thread submitting a job works on it too, so nested jobs can't deadlock.
+	 */
+	class ThreadPool
+	{
+	private:
+		struct Job
+		{
+			std::function<void(size_t)> run;
+			size_t chunks = 0;
+			std::atomic<size_t> next{ 0 };
+			std::atomic<size_t> done{ 0 };
+			std::mutex doneMutex;
+			std::condition_variable doneCV;
+			std::exception_ptr exception;
+			std::mutex exceptionMutex;
+		};
+
+		std::vector<std::thread> _workers;
+		std::deque<std::shared_ptr<Job>> _jobs;
+		std::mutex _mutex;
+		std::condition_variable _cv;
+		bool _stop = false;
+
+		// Runs chunks of `job` until there are none left.
+		static void work(Job& job)
+		{
+			size_t i;
+			while((i = job.next.fetch_add(1)) < job.chunks)
+			{
+				try
+				{
+					job.run(i);
+				}
+				catch(...)
+				{
+					std::lock_guard lock(job.exceptionMutex);
+					if(!job.exception)
+						job.exception = std::current_exception();
+				}
+
+				if(job.done.fetch_add(1) + 1 == job.chunks)
+				{
+					std::lock_guard lock(job.doneMutex);
+					job.doneCV.notify_all();
+				}
+			}
+		}
+
+		void workerLoop()
+		{
+			while(true)
+			{
+				std::shared_ptr<Job> job;
+				{
+					std::unique_lock lock(_mutex);
+					_cv.wait(lock, [this] { return _stop || !_jobs.empty(); });
+					if(_stop) return;
+
+					job = _jobs.front();
+					// everything is already taken, nothing left to help with
+					if(job->next.load() >= job->chunks)
+					{
+						_jobs.pop_front();
+						continue;
+					}
+				}
+				work(*job);
+			}
+		}
+
+	public:
+		/**
+		 * @param workers The amount of worker threads. The thread calling `run()` works as well, so 0 is valid.
+		 */
+		ThreadPool(size_t workers)
+		{
+			_workers.reserve(workers);
+			for(size_t i = 0; i < workers; i++)
+				_workers.emplace_back([this] { workerLoop(); });
+		}
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		~ThreadPool()
+		{
+			{
+				std::lock_guard lock(_mutex);
+				_stop = true;
+			}
+			_cv.notify_all();
+			for(auto& w : _workers)
+				w.join();
+		}
+
+		size_t workerCount() const { return _workers.size(); }
+
+		/**
+		 * Runs `f(chunkIndex)` for every chunk in [0, chunks) and waits for all of them to finish.
+		 * The first exception thrown by `f` gets rethrown here.
+		 */
+		void run(size_t chunks, const std::function<void(size_t)>& f)
+		{
+			if(chunks == 0) return;
+
+			if(_workers.empty() || chunks == 1)
+			{
+				for(size_t i = 0; i < chunks; i++)
+					f(i);
+				return;
+			}
+
+			auto job = std::make_shared<Job>();
+			job->run = f;
+			job->chunks = chunks;
+			{
+				std::lock_guard lock(_mutex);
+				_jobs.push_back(job);
+			}
+			_cv.notify_all();
+
+			work(*job);
+
+			{
+				std::unique_lock lock(job->doneMutex);
+				job->doneCV.wait(lock, [&] { return job->done.load() == job->chunks; });
+			}
+			{
+				std::lock_guard lock(_mutex);
+				auto it = std::find(_jobs.begin(), _jobs.end(), job);
+				if(it != _jobs.end())
+					_jobs.erase(it);
+			}
+
+			if(job->exception)
+				std::rethrow_exception(job->exception);
+		}
+	};
+
+	// Whether an operation calling user code may split the work across threads (see Parallel), or has to stay on the calling thread.
+	enum class Execution : uint8_t
+	{
+		Serial, // In order, on the calling thread. Safe for callables with state.
+		Parallel, // In chunks, possibly on several threads at once. The callable has to be thread-safe.
+	};
+
+	/**
+	 * Library-wide settings and helpers for running bulk operations on multiple threads.
+	 * Work is always split into chunks of a fixed size which don't depend on the thread count,
+	 * and partial results get combined in chunk order, so the results are the same no matter how many threads are used.
+	 */
+	class Parallel
+	{
+	private:
+		inline static std::atomic<size_t> _threadCount{ 0 };
+		inline static std::atomic<size_t> _chunkSize{ 16384 };
+		inline static std::shared_ptr<ThreadPool> _pool{};
+		inline static std::mutex _poolMutex;
+
+	public:
+		/**
+		 * Sets the default amount of elements per chunk. Operations already running keep the size they started with.
+		 * @param size The chunk size. 0 counts as 1.
+		 */
+		inline static void setChunkSize(size_t size) { _chunkSize = std::max<size_t>(size, 1); }
+		/**
+		 * @returns The default amount of elements per chunk.
+		 */
+		inline static size_t getChunkSize() { return _chunkSize.load(std::memory_order_relaxed); }
+
+		/**
+		 * Sets the amount of threads used by bulk operations.
+		 * Operations already running keep using the old pool, which shuts down once they're done.
+		 * @param count The thread count. 0 uses std::thread::hardware_concurrency(), 1 runs everything on the calling thread.
+		 */
+		inline static void setThreadCount(size_t count)
+		{
+			std::lock_guard lock(_poolMutex);
+			_threadCount = count;
+			_pool.reset();
+		}
+		/**
+		 * @returns The amount of threads used by bulk operations.
+		 */
+		inline static size_t getThreadCount()
+		{
+			const size_t count = _threadCount.load();
+			if(count != 0) return count;
+			return std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		/**
+		 * @returns The shared thread pool. It's created on first use. Keep the pointer for as long as the pool is used,
+		 *          `setThreadCount` replaces it.
+		 */
+		inline static std::shared_ptr<ThreadPool> pool()
+		{
+			std::lock_guard lock(_poolMutex);
+			if(!_pool)
+				_pool = std::make_shared<ThreadPool>(getThreadCount() - 1);
+			return _pool;
+		}
+
+		/**
+		 * Calls `f(begin, end)` for consecutive ranges of at most `chunk` elements covering [0, count).
+		 * Ranges may run concurrently. Runs on the calling thread alone when there's only one chunk.
+		 */
+		template<typename F>
+		inline static void forChunks(size_t count, F&& f, size_t chunk = getChunkSize())
+		{
+			if(count == 0) return;
+			if(chunk == 0) chunk = count;
+
+			size_t chunks = (count + chunk - 1) / chunk;
+			if(chunks == 1 || getThreadCount() == 1)
+			{
+				for(size_t begin = 0; begin < count; begin += chunk)
+					f(begin, std::min(begin + chunk, count));
+				return;
+			}
+
+			const std::shared_ptr<ThreadPool> p = pool();
+			p->run(chunks, [&](size_t i)
+				{
+					size_t begin = i * chunk;
+					f(begin, std::min(begin + chunk, count));
+				});
+		}
+
+		/**
+		 * Computes `map(begin, end)` for every chunk (like `forChunks`) and folds the results with `combine` in chunk order.
+		 * @returns `init` combined with every partial result.
+		 */
+		template<typename T, typename M, typename C>
+		inline static T reduceChunks(size_t count, T init, M&& map, C&& combine, size_t chunk = getChunkSize())
+		{
+			if(count == 0) return init;
+			if(chunk == 0) chunk = count;
+
+			std::vector<T> partials((count + chunk - 1) / chunk, init);
+			forChunks(count, [&](size_t begin, size_t end) { partials[begin / chunk] = map(begin, end); }, chunk);
+
+			T result = init;
+			for(auto& p : partials)
+				result = combine(result, p);
+			return result;
+		}
+
+		/**
+		 * Stable LSD radix sort of `keys`, moving `values` along with them.
+		 * Digit histograms and scatters run per chunk across threads, and chunks are laid out in order,
+		 * so the result is the same as a serial stable sort. Bytes that are the same in every key are skipped.
+		 */
+		inline static void radixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, size_t chunk = getChunkSize())
+		{
+			const size_t count = keys.size();
+			if(count < 2) return;
+			if(chunk == 0) chunk = count;
+			const size_t chunks = (count + chunk - 1) / chunk;
+
+			const uint64_t first = keys[0];
+			const uint64_t varying = reduceChunks(count, uint64_t{ 0 },
+				[&](size_t begin, size_t end)
+				{
+					uint64_t bits = 0;
+					for(size_t i = begin; i < end; i++)
+						bits |= keys[i] ^ first;
+					return bits;
+				},
+				[](uint64_t a, uint64_t b) { return a | b; }, chunk);
+
+			std::vector<uint64_t> keysOut(count);
+			std::vector<uint32_t> valuesOut(count);
+			std::vector<std::array<size_t, 256>> offsets(chunks);
+
+			for(int shift = 0; shift < 64; shift += 8)
+			{
+				if(((varying >> shift) & 0xFF) == 0)
+					continue;
+
+				forChunks(count, [&](size_t begin, size_t end)
+					{
+						auto& h = offsets[begin / chunk];
+						h.fill(0);
+						for(size_t i = begin; i < end; i++)
+							h[(keys[i] >> shift) & 0xFF]++;
+					}, chunk);
+
+				// digit-major, chunk-minor, which keeps equal digits in their original order
+				size_t sum = 0;
+				for(size_t d = 0; d < 256; d++)
+					for(size_t c = 0; c < chunks; c++)
+					{
+						size_t n = offsets[c][d];
+						offsets[c][d] = sum;
+						sum += n;
+					}
+
+				forChunks(count, [&](size_t begin, size_t end)
+					{
+						auto& o = offsets[begin / chunk];
+						for(size_t i = begin; i < end; i++)
+						{
+							size_t pos = o[(keys[i] >> shift) & 0xFF]++;
+							keysOut[pos] = keys[i];
+							valuesOut[pos] = values[i];
+						}
+					}, chunk);
+
+				keys.swap(keysOut);
+				values.swap(valuesOut);
+			}
+		}
+	};
+}
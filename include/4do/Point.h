@@ -257,6 +257,9 @@ namespace fdo
 		#endif
 	};
 
+	// the SIMD kernels rely on Points being tightly packed
+	static_assert(sizeof(Point) == sizeof(float) * 4);
+
 	// additional names
 
 	typedef Point vec4;
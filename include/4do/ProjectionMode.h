@@ -0,0 +1,13 @@
+#pragma once
+
+#include "basicIncludes.h"
+
+namespace fdo
+{
+	// How 4D positions get flattened into 3D.
+	enum class ProjectionMode : uint8_t
+	{
+		Orthographic, // Drops w.
+		Perspective, // Divides by the distance along w to an eye sitting on the w axis.
+	};
+}
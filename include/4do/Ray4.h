@@ -0,0 +1,28 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Point.h"
+
+namespace fdo
+{
+	// A 4D ray. Only the part between `tMin` and `tMax` (in multiples of `direction`) counts.
+	struct Ray4
+	{
+		Point origin{ 0,0,0,0 };
+		Point direction{ 0,0,0,1 };
+		float tMin = 0;
+		float tMax = std::numeric_limits<float>::infinity();
+
+		Point at(float t) const { return origin + direction * t; }
+	};
+
+	// Where a ray hit a tetrahedron.
+	struct Hit
+	{
+		float t = std::numeric_limits<float>::infinity(); // Ray parameter of the hit.
+		int32_t tetrahedron = -1; // Index of the tetrahedron that got hit, -1 if nothing did.
+		float barycentrics[4]{}; // Weights of the 4 tetrahedron corners at the hit. Use them to interpolate the corner attributes.
+
+		bool isHit() const { return tetrahedron >= 0; }
+	};
+}
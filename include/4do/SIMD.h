@@ -0,0 +1,577 @@
+#pragma once
+
+#include "basicIncludes.h"
+
+// Define FDO_NO_SIMD before including 4DO-Lib to force the scalar fallbacks.
+#ifndef FDO_NO_SIMD
+	#if defined(__AVX__)
+		#include <immintrin.h>
+		#define FDO_SIMD_AVX
+	#endif
+	#if defined(__F16C__)
+		#include <immintrin.h>
+		#define FDO_SIMD_F16C
+	#endif
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#include <emmintrin.h>
+		#define FDO_SIMD_SSE2
+	#endif
+	#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+		#include <xmmintrin.h>
+		#define FDO_SIMD_SSE
+	#elif defined(__ARM_NEON) || defined(_M_ARM64)
+		#include <arm_neon.h>
+		#define FDO_SIMD_NEON
+	#endif
+#endif
+
+// Kernels working on tightly packed arrays of 4-float elements (fdo::Point and anything laid out like it).
+// `count` is always the amount of elements, not floats.
+namespace fdo::simd
+{
+	/**
+	 * data[i] += add
+	 */
+	inline void add4(float* data, size_t count, const float (&add)[4])
+	{
+		size_t i = 0;
+	#if defined(FDO_SIMD_AVX)
+		const __m256 a8 = _mm256_setr_ps(add[0], add[1], add[2], add[3], add[0], add[1], add[2], add[3]);
+		for(; i + 2 <= count; i += 2)
+			_mm256_storeu_ps(data + i * 4, _mm256_add_ps(_mm256_loadu_ps(data + i * 4), a8));
+	#endif
+	#if defined(FDO_SIMD_SSE)
+		const __m128 a4 = _mm_loadu_ps(add);
+		for(; i < count; i++)
+			_mm_storeu_ps(data + i * 4, _mm_add_ps(_mm_loadu_ps(data + i * 4), a4));
+	#elif defined(FDO_SIMD_NEON)
+		const float32x4_t a4 = vld1q_f32(add);
+		for(; i < count; i++)
+			vst1q_f32(data + i * 4, vaddq_f32(vld1q_f32(data + i * 4), a4));
+	#endif
+		for(; i < count; i++)
+			for(int j = 0; j < 4; j++)
+				data[i * 4 + j] += add[j];
+	}
+
+	/**
+	 * data[i] = origin + (data[i] - origin) * scale
+	 */
+	inline void scale4(float* data, size_t count, const float (&scale)[4], const float (&origin)[4])
+	{
+		size_t i = 0;
+	#if defined(FDO_SIMD_AVX)
+		const __m256 s8 = _mm256_setr_ps(scale[0], scale[1], scale[2], scale[3], scale[0], scale[1], scale[2], scale[3]);
+		const __m256 o8 = _mm256_setr_ps(origin[0], origin[1], origin[2], origin[3], origin[0], origin[1], origin[2], origin[3]);
+		for(; i + 2 <= count; i += 2)
+		{
+			__m256 v = _mm256_loadu_ps(data + i * 4);
+			_mm256_storeu_ps(data + i * 4, _mm256_add_ps(o8, _mm256_mul_ps(_mm256_sub_ps(v, o8), s8)));
+		}
+	#endif
+	#if defined(FDO_SIMD_SSE)
+		const __m128 s4 = _mm_loadu_ps(scale);
+		const __m128 o4 = _mm_loadu_ps(origin);
+		for(; i < count; i++)
+		{
+			__m128 v = _mm_loadu_ps(data + i * 4);
+			_mm_storeu_ps(data + i * 4, _mm_add_ps(o4, _mm_mul_ps(_mm_sub_ps(v, o4), s4)));
+		}
+	#elif defined(FDO_SIMD_NEON)
+		const float32x4_t s4 = vld1q_f32(scale);
+		const float32x4_t o4 = vld1q_f32(origin);
+		for(; i < count; i++)
+		{
+			float32x4_t v = vld1q_f32(data + i * 4);
+			vst1q_f32(data + i * 4, vaddq_f32(o4, vmulq_f32(vsubq_f32(v, o4), s4)));
+		}
+	#endif
+		for(; i < count; i++)
+			for(int j = 0; j < 4; j++)
+				data[i * 4 + j] = origin[j] + (data[i * 4 + j] - origin[j]) * scale[j];
+	}
+
+	/**
+	 * data[i] = m * data[i] + t
+	 * @param m A column-major 4x4 matrix.
+	 */
+	inline void transform4(float* data, size_t count, const float (&m)[16], const float (&t)[4])
+	{
+		size_t i = 0;
+	#if defined(FDO_SIMD_AVX)
+		const __m256 c08 = _mm256_setr_ps(m[0], m[1], m[2], m[3], m[0], m[1], m[2], m[3]);
+		const __m256 c18 = _mm256_setr_ps(m[4], m[5], m[6], m[7], m[4], m[5], m[6], m[7]);
+		const __m256 c28 = _mm256_setr_ps(m[8], m[9], m[10], m[11], m[8], m[9], m[10], m[11]);
+		const __m256 c38 = _mm256_setr_ps(m[12], m[13], m[14], m[15], m[12], m[13], m[14], m[15]);
+		const __m256 t8 = _mm256_setr_ps(t[0], t[1], t[2], t[3], t[0], t[1], t[2], t[3]);
+		for(; i + 2 <= count; i += 2)
+		{
+			__m256 v = _mm256_loadu_ps(data + i * 4);
+			__m256 r = _mm256_add_ps(t8, _mm256_mul_ps(c08, _mm256_permute_ps(v, 0x00)));
+			r = _mm256_add_ps(r, _mm256_mul_ps(c18, _mm256_permute_ps(v, 0x55)));
+			r = _mm256_add_ps(r, _mm256_mul_ps(c28, _mm256_permute_ps(v, 0xAA)));
+			r = _mm256_add_ps(r, _mm256_mul_ps(c38, _mm256_permute_ps(v, 0xFF)));
+			_mm256_storeu_ps(data + i * 4, r);
+		}
+	#endif
+	#if defined(FDO_SIMD_SSE)
+		const __m128 c0 = _mm_loadu_ps(m);
+		const __m128 c1 = _mm_loadu_ps(m + 4);
+		const __m128 c2 = _mm_loadu_ps(m + 8);
+		const __m128 c3 = _mm_loadu_ps(m + 12);
+		const __m128 t4 = _mm_loadu_ps(t);
+		for(; i < count; i++)
+		{
+			__m128 v = _mm_loadu_ps(data + i * 4);
+			__m128 r = _mm_add_ps(t4, _mm_mul_ps(c0, _mm_shuffle_ps(v, v, 0x00)));
+			r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, 0x55)));
+			r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, 0xAA)));
+			r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, 0xFF)));
+			_mm_storeu_ps(data + i * 4, r);
+		}
+	#elif defined(FDO_SIMD_NEON)
+		const float32x4_t c0 = vld1q_f32(m);
+		const float32x4_t c1 = vld1q_f32(m + 4);
+		const float32x4_t c2 = vld1q_f32(m + 8);
+		const float32x4_t c3 = vld1q_f32(m + 12);
+		const float32x4_t t4 = vld1q_f32(t);
+		for(; i < count; i++)
+		{
+			float32x4_t v = vld1q_f32(data + i * 4);
+			float32x4_t r = vmlaq_n_f32(t4, c0, vgetq_lane_f32(v, 0));
+			r = vmlaq_n_f32(r, c1, vgetq_lane_f32(v, 1));
+			r = vmlaq_n_f32(r, c2, vgetq_lane_f32(v, 2));
+			r = vmlaq_n_f32(r, c3, vgetq_lane_f32(v, 3));
+			vst1q_f32(data + i * 4, r);
+		}
+	#endif
+		for(; i < count; i++)
+		{
+			float v[4] = { data[i * 4 + 0], data[i * 4 + 1], data[i * 4 + 2], data[i * 4 + 3] };
+			for(int j = 0; j < 4; j++)
+				data[i * 4 + j] = t[j] + m[j] * v[0] + m[4 + j] * v[1] + m[8 + j] * v[2] + m[12 + j] * v[3];
+		}
+	}
+
+	/**
+	 * data[i] = normalize(m * data[i])
+	 * Zero-length results are left as they are, like Point::normalize does.
+	 * @param m A column-major 4x4 matrix.
+	 */
+	inline void transformNormalize4(float* data, size_t count, const float (&m)[16])
+	{
+		size_t i = 0;
+	#if defined(FDO_SIMD_SSE)
+		const __m128 c0 = _mm_loadu_ps(m);
+		const __m128 c1 = _mm_loadu_ps(m + 4);
+		const __m128 c2 = _mm_loadu_ps(m + 8);
+		const __m128 c3 = _mm_loadu_ps(m + 12);
+		const __m128 one = _mm_set1_ps(1.f);
+		const __m128 eps = _mm_set1_ps(0.00000001f);
+		for(; i < count; i++)
+		{
+			__m128 v = _mm_loadu_ps(data + i * 4);
+			__m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, 0x00));
+			r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, 0x55)));
+			r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, 0xAA)));
+			r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, 0xFF)));
+
+			// horizontal sum of squares into every lane
+			__m128 sq = _mm_mul_ps(r, r);
+			sq = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, 0xB1));
+			sq = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, 0x4E));
+			__m128 l = _mm_sqrt_ps(sq);
+			__m128 tooSmall = _mm_cmple_ps(l, eps);
+			l = _mm_or_ps(_mm_and_ps(tooSmall, one), _mm_andnot_ps(tooSmall, l));
+
+			_mm_storeu_ps(data + i * 4, _mm_mul_ps(r, _mm_div_ps(one, l)));
+		}
+	#elif defined(FDO_SIMD_NEON) && defined(__aarch64__)
+		const float32x4_t c0 = vld1q_f32(m);
+		const float32x4_t c1 = vld1q_f32(m + 4);
+		const float32x4_t c2 = vld1q_f32(m + 8);
+		const float32x4_t c3 = vld1q_f32(m + 12);
+		for(; i < count; i++)
+		{
+			float32x4_t v = vld1q_f32(data + i * 4);
+			float32x4_t r = vmulq_n_f32(c0, vgetq_lane_f32(v, 0));
+			r = vmlaq_n_f32(r, c1, vgetq_lane_f32(v, 1));
+			r = vmlaq_n_f32(r, c2, vgetq_lane_f32(v, 2));
+			r = vmlaq_n_f32(r, c3, vgetq_lane_f32(v, 3));
+
+			float l = sqrtf(vaddvq_f32(vmulq_f32(r, r)));
+			if(l <= 0.00000001f) l = 1;
+			vst1q_f32(data + i * 4, vmulq_n_f32(r, 1.f / l));
+		}
+	#endif
+		for(; i < count; i++)
+		{
+			float v[4] = { data[i * 4 + 0], data[i * 4 + 1], data[i * 4 + 2], data[i * 4 + 3] };
+			float r[4];
+			for(int j = 0; j < 4; j++)
+				r[j] = m[j] * v[0] + m[4 + j] * v[1] + m[8 + j] * v[2] + m[12 + j] * v[3];
+			float l = sqrtf(r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]);
+			if(l <= 0.00000001f) l = 1;
+			float lInv = 1.f / l;
+			for(int j = 0; j < 4; j++)
+				data[i * 4 + j] = r[j] * lInv;
+		}
+	}
+
+	/**
+	 * Accumulates the component-wise min, max and sum of the elements in one pass.
+	 * `min`, `max` and `sum` have to be initialized by the caller.
+	 * Elements are summed in order, so the sum matches a plain scalar loop exactly.
+	 */
+	inline void boundsSum4(const float* data, size_t count, float (&min)[4], float (&max)[4], float (&sum)[4])
+	{
+		size_t i = 0;
+	#if defined(FDO_SIMD_SSE)
+		__m128 mn = _mm_loadu_ps(min);
+		__m128 mx = _mm_loadu_ps(max);
+		__m128 sm = _mm_loadu_ps(sum);
+		for(; i < count; i++)
+		{
+			__m128 v = _mm_loadu_ps(data + i * 4);
+			mn = _mm_min_ps(mn, v);
+			mx = _mm_max_ps(mx, v);
+			sm = _mm_add_ps(sm, v);
+		}
+		_mm_storeu_ps(min, mn);
+		_mm_storeu_ps(max, mx);
+		_mm_storeu_ps(sum, sm);
+	#elif defined(FDO_SIMD_NEON)
+		float32x4_t mn = vld1q_f32(min);
+		float32x4_t mx = vld1q_f32(max);
+		float32x4_t sm = vld1q_f32(sum);
+		for(; i < count; i++)
+		{
+			float32x4_t v = vld1q_f32(data + i * 4);
+			mn = vminq_f32(mn, v);
+			mx = vmaxq_f32(mx, v);
+			sm = vaddq_f32(sm, v);
+		}
+		vst1q_f32(min, mn);
+		vst1q_f32(max, mx);
+		vst1q_f32(sum, sm);
+	#endif
+		for(; i < count; i++)
+			for(int j = 0; j < 4; j++)
+			{
+				float v = data[i * 4 + j];
+				min[j] = std::min(min[j], v);
+				max[j] = std::max(max[j], v);
+				sum[j] += v;
+			}
+	}
+
+	/**
+	 * out[i] = dot(data[i], n) - offset
+	 * (signed distances to a hyperplane when `n` is normalized)
+	 */
+	inline void planeDistances4(const float* data, size_t count, const float (&n)[4], float offset, float* out)
+	{
+		size_t i = 0;
+	#if defined(FDO_SIMD_SSE)
+		const __m128 nx = _mm_set1_ps(n[0]);
+		const __m128 ny = _mm_set1_ps(n[1]);
+		const __m128 nz = _mm_set1_ps(n[2]);
+		const __m128 nw = _mm_set1_ps(n[3]);
+		const __m128 off = _mm_set1_ps(offset);
+		// 4 elements at a time, transposed so each register holds one component of all 4
+		for(; i + 4 <= count; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(data + i * 4 + 0);
+			__m128 y = _mm_loadu_ps(data + i * 4 + 4);
+			__m128 z = _mm_loadu_ps(data + i * 4 + 8);
+			__m128 w = _mm_loadu_ps(data + i * 4 + 12);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			__m128 d = _mm_mul_ps(x, nx);
+			d = _mm_add_ps(d, _mm_mul_ps(y, ny));
+			d = _mm_add_ps(d, _mm_mul_ps(z, nz));
+			d = _mm_add_ps(d, _mm_mul_ps(w, nw));
+			_mm_storeu_ps(out + i, _mm_sub_ps(d, off));
+		}
+	#elif defined(FDO_SIMD_NEON)
+		for(; i + 4 <= count; i += 4)
+		{
+			float32x4x4_t v = vld4q_f32(data + i * 4); // de-interleaves into x, y, z, w
+			float32x4_t d = vmulq_n_f32(v.val[0], n[0]);
+			d = vmlaq_n_f32(d, v.val[1], n[1]);
+			d = vmlaq_n_f32(d, v.val[2], n[2]);
+			d = vmlaq_n_f32(d, v.val[3], n[3]);
+			vst1q_f32(out + i, vsubq_f32(d, vdupq_n_f32(offset)));
+		}
+	#endif
+		for(; i < count; i++)
+		{
+			const float* v = data + i * 4;
+			out[i] = v[0] * n[0] + v[1] * n[1] + v[2] * n[2] + v[3] * n[3] - offset;
+		}
+	}
+
+	/**
+	 * Projects 4D elements into tightly packed 3D positions (3 floats each).
+	 * Perspective: out[i] = xyz * eyeW / (eyeW - w), as seen from an eye at `w = eyeW` looking towards -w.
+	 * Orthographic: out[i] = xyz
+	 */
+	inline void project3(const float* data, size_t count, bool perspective, float eyeW, float* out)
+	{
+		size_t i = 0;
+	#if defined(FDO_SIMD_SSE)
+		const __m128 eye = _mm_set1_ps(eyeW);
+		for(; i + 4 <= count; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(data + i * 4 + 0);
+			__m128 y = _mm_loadu_ps(data + i * 4 + 4);
+			__m128 z = _mm_loadu_ps(data + i * 4 + 8);
+			__m128 w = _mm_loadu_ps(data + i * 4 + 12);
+			if(perspective)
+			{
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+				__m128 f = _mm_div_ps(eye, _mm_sub_ps(eye, w));
+				x = _mm_mul_ps(x, f);
+				y = _mm_mul_ps(y, f);
+				z = _mm_mul_ps(z, f);
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+			}
+			// each store spills one float into the next element, which the next store overwrites
+			float* o = out + i * 3;
+			_mm_storeu_ps(o + 0, x);
+			_mm_storeu_ps(o + 3, y);
+			_mm_storeu_ps(o + 6, z);
+			alignas(16) float last[4];
+			_mm_store_ps(last, w);
+			o[9] = last[0]; o[10] = last[1]; o[11] = last[2];
+		}
+	#elif defined(FDO_SIMD_NEON) && defined(__aarch64__)
+		const float32x4_t eye = vdupq_n_f32(eyeW);
+		for(; i + 4 <= count; i += 4)
+		{
+			float32x4x4_t v = vld4q_f32(data + i * 4);
+			float32x4x3_t r = { { v.val[0], v.val[1], v.val[2] } };
+			if(perspective)
+			{
+				float32x4_t f = vdivq_f32(eye, vsubq_f32(eye, v.val[3]));
+				r.val[0] = vmulq_f32(r.val[0], f);
+				r.val[1] = vmulq_f32(r.val[1], f);
+				r.val[2] = vmulq_f32(r.val[2], f);
+			}
+			vst3q_f32(out + i * 3, r); // interleaves back into xyz triples
+		}
+	#endif
+		for(; i < count; i++)
+		{
+			const float* v = data + i * 4;
+			const float f = perspective ? eyeW / (eyeW - v[3]) : 1.f;
+			out[i * 3 + 0] = v[0] * f;
+			out[i * 3 + 1] = v[1] * f;
+			out[i * 3 + 2] = v[2] * f;
+		}
+	}
+
+	/**
+	 * Converts a float to a half float (IEEE binary16), rounding to nearest even.
+	 * Too large values become infinity, NaNs stay NaNs.
+	 */
+	inline uint16_t toHalf(float value)
+	{
+		uint32_t f = std::bit_cast<uint32_t>(value);
+		const uint32_t sign = f & 0x80000000u;
+		f ^= sign;
+
+		uint32_t h;
+		if(f >= (127u + 16) << 23) // too large for a half, or inf/NaN
+			h = f > 255u << 23 ? 0x7E00 : 0x7C00;
+		else if(f < (127u - 14) << 23) // becomes a subnormal half, let the float adder do the rounding
+		{
+			const uint32_t magic = ((127u - 15) + (23 - 10) + 1) << 23;
+			h = std::bit_cast<uint32_t>(std::bit_cast<float>(f) + std::bit_cast<float>(magic)) - magic;
+		}
+		else
+		{
+			const uint32_t mantissaOdd = (f >> 13) & 1;
+			f += ((uint32_t)(15 - 127) << 23) + 0xFFF + mantissaOdd;
+			h = f >> 13;
+		}
+		return (uint16_t)(h | sign >> 16);
+	}
+
+	/**
+	 * out[i] = half floats of data[i], 4 per element. Rounds like `toHalf`.
+	 */
+	inline void toHalf4(const float* data, size_t count, uint16_t* out)
+	{
+		size_t i = 0;
+	#if defined(FDO_SIMD_F16C)
+		for(; i + 2 <= count; i += 2)
+			_mm_storeu_si128((__m128i*)(out + i * 4), _mm256_cvtps_ph(_mm256_loadu_ps(data + i * 4), _MM_FROUND_TO_NEAREST_INT));
+	#elif defined(FDO_SIMD_SSE2)
+		// toHalf on 4 lanes at once, with selects instead of branches
+		const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+		const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+		const __m128i subnormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+		const __m128i normalBias = _mm_set1_epi32(0xFFF - ((127 - 15) << 23));
+		const __m128i infinity = _mm_set1_epi32(0x7C00);
+		const __m128i nanBit = _mm_set1_epi32(0x200);
+		const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u));
+		auto convert = [&](__m128 v)
+			{
+				const __m128 sign = _mm_and_ps(v, signMask);
+				const __m128 abs = _mm_xor_ps(v, sign);
+				const __m128i absInt = _mm_castps_si128(abs);
+
+				const __m128i isRegular = _mm_cmpgt_epi32(f16Max, absInt);
+				const __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absInt);
+				const __m128i special = _mm_or_si128(infinity, _mm_and_si128(_mm_castps_si128(_mm_cmpunord_ps(abs, abs)), nanBit));
+
+				const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(abs, _mm_castsi128_ps(subnormalMagic))), subnormalMagic);
+				const __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(absInt, 31 - 13), 31); // -1 when odd
+				const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absInt, normalBias), mantissaOdd), 13);
+
+				__m128i h = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+				h = _mm_or_si128(_mm_and_si128(isRegular, h), _mm_andnot_si128(isRegular, special));
+				// the sign lands in bit 15 and above, which keeps every lane within int16 for the saturating pack
+				return _mm_or_si128(h, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+			};
+		for(; i + 2 <= count; i += 2)
+		{
+			const __m128i a = convert(_mm_loadu_ps(data + i * 4));
+			const __m128i b = convert(_mm_loadu_ps(data + i * 4 + 4));
+			_mm_storeu_si128((__m128i*)(out + i * 4), _mm_packs_epi32(a, b));
+		}
+	#elif defined(FDO_SIMD_NEON) && defined(__aarch64__)
+		for(; i < count; i++)
+			vst1_u16(out + i * 4, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(data + i * 4))));
+	#endif
+		for(; i < count; i++)
+			for(int j = 0; j < 4; j++)
+				out[i * 4 + j] = toHalf(data[i * 4 + j]);
+	}
+
+	/**
+	 * out[i] = round(clamp(data[i], -1, 1) * 32767), rounding to nearest even. NaNs become -32767.
+	 */
+	inline void toSnorm16x4(const float* data, size_t count, int16_t* out)
+	{
+		size_t i = 0;
+	#if defined(FDO_SIMD_SSE2)
+		const __m128 lo = _mm_set1_ps(-1.f);
+		const __m128 hi = _mm_set1_ps(1.f);
+		const __m128 scale = _mm_set1_ps(32767.f);
+		auto convert = [&](const float* v) { return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(v), lo), hi), scale)); };
+		for(; i + 2 <= count; i += 2)
+			_mm_storeu_si128((__m128i*)(out + i * 4), _mm_packs_epi32(convert(data + i * 4), convert(data + i * 4 + 4)));
+	#elif defined(FDO_SIMD_NEON) && defined(__aarch64__)
+		const float32x4_t lo = vdupq_n_f32(-1.f);
+		const float32x4_t hi = vdupq_n_f32(1.f);
+		for(; i < count; i++)
+		{
+			const float32x4_t v = vminnmq_f32(vmaxnmq_f32(vld1q_f32(data + i * 4), lo), hi);
+			vst1_s16(out + i * 4, vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(v, 32767.f))));
+		}
+	#endif
+		for(; i < count; i++)
+			for(int j = 0; j < 4; j++)
+			{
+				const float v = data[i * 4 + j];
+				out[i * 4 + j] = (int16_t)std::nearbyint((v > -1.f ? (v < 1.f ? v : 1.f) : -1.f) * 32767.f);
+			}
+	}
+
+	/**
+	 * out[i] = round(clamp(data[i], -1, 1) * 127), rounding to nearest even. NaNs become -127.
+	 */
+	inline void toSnorm8x4(const float* data, size_t count, int8_t* out)
+	{
+		size_t i = 0;
+	#if defined(FDO_SIMD_SSE2)
+		const __m128 lo = _mm_set1_ps(-1.f);
+		const __m128 hi = _mm_set1_ps(1.f);
+		const __m128 scale = _mm_set1_ps(127.f);
+		auto convert = [&](const float* v) { return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(v), lo), hi), scale)); };
+		for(; i + 4 <= count; i += 4)
+		{
+			const __m128i a = _mm_packs_epi32(convert(data + i * 4), convert(data + i * 4 + 4));
+			const __m128i b = _mm_packs_epi32(convert(data + i * 4 + 8), convert(data + i * 4 + 12));
+			_mm_storeu_si128((__m128i*)(out + i * 4), _mm_packs_epi16(a, b));
+		}
+	#elif defined(FDO_SIMD_NEON) && defined(__aarch64__)
+		const float32x4_t lo = vdupq_n_f32(-1.f);
+		const float32x4_t hi = vdupq_n_f32(1.f);
+		for(; i + 2 <= count; i += 2)
+		{
+			const float32x4_t a = vminnmq_f32(vmaxnmq_f32(vld1q_f32(data + i * 4), lo), hi);
+			const float32x4_t b = vminnmq_f32(vmaxnmq_f32(vld1q_f32(data + i * 4 + 4), lo), hi);
+			const int16x8_t s = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(a, 127.f))), vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(b, 127.f))));
+			vst1_s8(out + i * 4, vqmovn_s16(s));
+		}
+	#endif
+		for(; i < count; i++)
+			for(int j = 0; j < 4; j++)
+			{
+				const float v = data[i * 4 + j];
+				out[i * 4 + j] = (int8_t)std::nearbyint((v > -1.f ? (v < 1.f ? v : 1.f) : -1.f) * 127.f);
+			}
+	}
+
+	/**
+	 * out[i] = round(clamp(data[i], 0, 1) * 255), rounding to nearest even. NaNs become 0.
+	 */
+	inline void toUnorm8x4(const float* data, size_t count, uint8_t* out)
+	{
+		size_t i = 0;
+	#if defined(FDO_SIMD_SSE2)
+		const __m128 lo = _mm_set1_ps(0.f);
+		const __m128 hi = _mm_set1_ps(1.f);
+		const __m128 scale = _mm_set1_ps(255.f);
+		auto convert = [&](const float* v) { return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(v), lo), hi), scale)); };
+		for(; i + 4 <= count; i += 4)
+		{
+			const __m128i a = _mm_packs_epi32(convert(data + i * 4), convert(data + i * 4 + 4));
+			const __m128i b = _mm_packs_epi32(convert(data + i * 4 + 8), convert(data + i * 4 + 12));
+			_mm_storeu_si128((__m128i*)(out + i * 4), _mm_packus_epi16(a, b));
+		}
+	#elif defined(FDO_SIMD_NEON) && defined(__aarch64__)
+		const float32x4_t lo = vdupq_n_f32(0.f);
+		const float32x4_t hi = vdupq_n_f32(1.f);
+		for(; i + 2 <= count; i += 2)
+		{
+			const float32x4_t a = vminnmq_f32(vmaxnmq_f32(vld1q_f32(data + i * 4), lo), hi);
+			const float32x4_t b = vminnmq_f32(vmaxnmq_f32(vld1q_f32(data + i * 4 + 4), lo), hi);
+			const int16x8_t s = vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(a, 255.f))), vqmovn_s32(vcvtnq_s32_f32(vmulq_n_f32(b, 255.f))));
+			vst1_u8(out + i * 4, vqmovun_s16(s));
+		}
+	#endif
+		for(; i < count; i++)
+			for(int j = 0; j < 4; j++)
+			{
+				const float v = data[i * 4 + j];
+				out[i * 4 + j] = (uint8_t)std::nearbyint((v > 0.f ? (v < 1.f ? v : 1.f) : 0.f) * 255.f);
+			}
+	}
+
+	/**
+	 * out[i] = in[i] for `count` 32-bit indices (not elements) that all fit in 16 bits.
+	 */
+	inline void narrow16(const uint32_t* in, size_t count, uint16_t* out)
+	{
+		size_t i = 0;
+	#if defined(FDO_SIMD_SSE2)
+		// bias into int16 range so the signed saturating pack keeps every value
+		const __m128i bias32 = _mm_set1_epi32(0x8000);
+		const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+		for(; i + 8 <= count; i += 8)
+		{
+			const __m128i a = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(in + i)), bias32);
+			const __m128i b = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(in + i + 4)), bias32);
+			_mm_storeu_si128((__m128i*)(out + i), _mm_add_epi16(_mm_packs_epi32(a, b), bias16));
+		}
+	#elif defined(FDO_SIMD_NEON)
+		for(; i + 8 <= count; i += 8)
+			vst1q_u16(out + i, vcombine_u16(vmovn_u32(vld1q_u32(in + i)), vmovn_u32(vld1q_u32(in + i + 4))));
+	#endif
+		for(; i < count; i++)
+			out[i] = (uint16_t)in[i];
+	}
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "basicIncludes.h"
+
+namespace fdo
+{
+	/**
+	 * A reference-counted, copy-on-write array.
+	 * Copying a SharedBuffer is O(1) and only shares the underlying data; the data gets duplicated
+	 * the first time a shared buffer is written to.
+	 * Element access (`[]`, `at`, iterators, `data`) is read-only and never copies anything. Writing to elements goes
+	 * through `mutate()`, which hands out the underlying `std::vector` (also what to pass where a `std::vector<T>&` is expected):
+	 *     obj.vertices.mutate()[i] = p;
+	 *     for(Point& p : obj.vertices.mutate()) ...
+	 * Appending, resizing, inserting and erasing work like on a `std::vector` and detach on their own.
+	 * Every write also marks the buffer as written to, and the next `version()` call hands out a new stamp,
+	 * which lets dependent caches know when to update.
+	 * Aliasing: References, pointers and iterators from `mutate()` (or the ones `emplace_back`/`insert`/`erase` return)
+	 * point into data which a copy of the buffer shares afterwards, so writing through them after copying changes the copy
+	 * as well. Call `mutate()` again after copying instead of keeping them around.
+	 * Note: Detaching is not synchronized, don't write to the same SharedBuffer from multiple threads.
+	 */
+	template<typename T>
+	class SharedBuffer
+	{
+	private:
+		std::shared_ptr<std::vector<T>> _data;
+		// stamps are only taken when asked for, so writes in a loop don't all hit the shared counter
+		mutable uint64_t _version = 0;
+		mutable bool _dirty = false;
+
+		inline static const std::vector<T> _empty{};
+		inline static std::atomic<uint64_t> _nextVersion{ 1 };
+
+		void bumpVersion() { _dirty = true; }
+
+	public:
+		using value_type = T;
+		using size_type = typename std::vector<T>::size_type;
+		using reference = T&;
+		using const_reference = const T&;
+		using iterator = typename std::vector<T>::iterator;
+		using const_iterator = typename std::vector<T>::const_iterator;
+
+		SharedBuffer() = default;
+		SharedBuffer(const std::vector<T>& data) : _data(std::make_shared<std::vector<T>>(data)) { bumpVersion(); }
+		SharedBuffer(std::vector<T>&& data) : _data(std::make_shared<std::vector<T>>(std::move(data))) { bumpVersion(); }
+		SharedBuffer(std::initializer_list<T> data) : _data(std::make_shared<std::vector<T>>(data)) { bumpVersion(); }
+		// Both buffers get the same stamp, taking one first if `other` was written to.
+		SharedBuffer(const SharedBuffer& other) : _data(other._data), _version(other.version()) {}
+		SharedBuffer(SharedBuffer&& other) noexcept : _data(std::move(other._data)), _version(other._version), _dirty(other._dirty)
+		{
+			other._version = 0;
+			other._dirty = false;
+		}
+
+		SharedBuffer& operator=(const SharedBuffer& other)
+		{
+			_version = other.version();
+			_dirty = false;
+			_data = other._data;
+			return *this;
+		}
+		SharedBuffer& operator=(SharedBuffer&& other) noexcept
+		{
+			_data = std::move(other._data);
+			_version = other._version;
+			_dirty = other._dirty;
+			other._version = 0;
+			other._dirty = false;
+			return *this;
+		}
+		SharedBuffer& operator=(const std::vector<T>& data)
+		{
+			_data = std::make_shared<std::vector<T>>(data);
+			bumpVersion();
+			return *this;
+		}
+		SharedBuffer& operator=(std::vector<T>&& data)
+		{
+			_data = std::make_shared<std::vector<T>>(std::move(data));
+			bumpVersion();
+			return *this;
+		}
+
+		// Read-only access to the data. Never copies.
+		const std::vector<T>& get() const { return _data ? *_data : _empty; }
+		// Writable access to the data. Copies the data first if it is shared with another SharedBuffer.
+		std::vector<T>& mutate()
+		{
+			bumpVersion();
+			if(!_data)
+				_data = std::make_shared<std::vector<T>>();
+			else if(_data.use_count() > 1)
+				_data = std::make_shared<std::vector<T>>(*_data);
+			return *_data;
+		}
+
+		/**
+		 * @returns A stamp which changes every time the data may have been written to.
+		 * Buffers sharing the same data have the same version. An empty default-constructed buffer has version 0.
+		 * Writes through references/iterators/pointers obtained earlier are not tracked.
+		 * Note: The first call after a write takes the new stamp, so it mustn't run concurrently with other calls on the same buffer.
+		 */
+		uint64_t version() const
+		{
+			if(_dirty)
+			{
+				_version = _nextVersion.fetch_add(1, std::memory_order_relaxed);
+				_dirty = false;
+			}
+			return _version;
+		}
+
+		// Whether the data is currently shared with another SharedBuffer.
+		bool isShared() const { return _data && _data.use_count() > 1; }
+		// Whether both buffers point to the same data.
+		bool sharesWith(const SharedBuffer& other) const { return _data && _data == other._data; }
+
+		operator const std::vector<T>&() const { return get(); }
+
+		size_type size() const { return get().size(); }
+		size_type capacity() const { return get().capacity(); }
+		bool empty() const { return get().empty(); }
+
+		const T* data() const { return get().data(); }
+
+		const T& operator[](size_type i) const { return get()[i]; }
+		const T& at(size_type i) const { return get().at(i); }
+		const T& front() const { return get().front(); }
+		const T& back() const { return get().back(); }
+
+		const_iterator begin() const { return get().begin(); }
+		const_iterator end() const { return get().end(); }
+		const_iterator cbegin() const { return get().cbegin(); }
+		const_iterator cend() const { return get().cend(); }
+
+		void push_back(const T& v) { mutate().push_back(v); }
+		void push_back(T&& v) { mutate().push_back(std::move(v)); }
+		template<typename... Args>
+		T& emplace_back(Args&&... args) { return mutate().emplace_back(std::forward<Args>(args)...); }
+		template<typename It>
+		iterator insert(const_iterator pos, It first, It last)
+		{
+			// `pos` may point into the data from before detaching, so go through the offset.
+			size_t offset = pos - get().begin();
+			std::vector<T>& d = mutate();
+			return d.insert(d.begin() + offset, first, last);
+		}
+		iterator erase(const_iterator first, const_iterator last)
+		{
+			size_t offsetFirst = first - get().begin();
+			size_t offsetLast = last - get().begin();
+			std::vector<T>& d = mutate();
+			return d.erase(d.begin() + offsetFirst, d.begin() + offsetLast);
+		}
+		iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+		void reserve(size_type n) { mutate().reserve(n); }
+		void resize(size_type n) { mutate().resize(n); }
+		void resize(size_type n, const T& v) { mutate().resize(n, v); }
+		void shrink_to_fit() { mutate().shrink_to_fit(); }
+		void clear()
+		{
+			bumpVersion();
+			// no need to copy data just to throw it away
+			if(isShared())
+				_data.reset();
+			else if(_data)
+				_data->clear();
+		}
+	};
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Point.h"
+
+namespace fdo
+{
+	class Object;
+
+	/**
+	 * Speeds up slicing the same Object along the same normal at different offsets (see Object::slice).
+	 * Stores the range each tetrahedron covers along the normal, sorted by both ends, and keeps track of the
+	 * tetrahedra crossing the last used offset. Moving the offset only visits the tetrahedra entering or
+	 * leaving the cut, so re-slicing costs about as much as the cut itself, not the whole mesh.
+	 * Gets rebuilt automatically when the Object's vertices or tetrahedra change.
+	 */
+	class SliceIndex
+	{
+	private:
+		friend class Object;
+
+		Point _normal{ 0,0,0,1 };
+
+		bool _built = false;
+		uint64_t _verticesVersion = 0;
+		uint64_t _tetrahedraVersion = 0;
+		size_t _verticesSize = 0;
+		size_t _tetrahedraSize = 0;
+
+		std::vector<float> _projections; // dot(normal, vertex) of every vertex
+		std::vector<float> _min; // lowest projection of every tetrahedron
+		std::vector<float> _max; // highest projection of every tetrahedron
+		std::vector<uint32_t> _byMin; // tetrahedra sorted by _min
+		std::vector<uint32_t> _byMax; // tetrahedra sorted by _max
+
+		// tetrahedron t crosses offset c when _min[t] <= c < _max[t]
+		std::vector<uint32_t> _active;
+		std::vector<uint32_t> _activePos; // position of each tetrahedron in _active, or `inactive`
+		float _offset = 0;
+		size_t _minCursor = 0; // amount of _byMin entries with _min <= _offset
+		size_t _maxCursor = 0; // amount of _byMax entries with _max <= _offset
+
+		inline static constexpr uint32_t inactive = std::numeric_limits<uint32_t>::max();
+
+		void activate(uint32_t t)
+		{
+			if(_activePos[t] != inactive) return;
+			_activePos[t] = (uint32_t)_active.size();
+			_active.push_back(t);
+		}
+		void deactivate(uint32_t t)
+		{
+			uint32_t pos = _activePos[t];
+			if(pos == inactive) return;
+			uint32_t last = _active.back();
+			_active[pos] = last;
+			_activePos[last] = pos;
+			_active.pop_back();
+			_activePos[t] = inactive;
+		}
+
+		// Sorts the ranges and sets the active set to the tetrahedra crossing `offset`. Expects _projections/_min/_max to be filled.
+		void finishBuild(float offset)
+		{
+			const size_t count = _min.size();
+
+			_byMin.resize(count);
+			_byMax.resize(count);
+			for(uint32_t i = 0; i < count; i++)
+				_byMin[i] = _byMax[i] = i;
+			std::sort(_byMin.begin(), _byMin.end(), [this](uint32_t a, uint32_t b) { return _min[a] < _min[b] || (_min[a] == _min[b] && a < b); });
+			std::sort(_byMax.begin(), _byMax.end(), [this](uint32_t a, uint32_t b) { return _max[a] < _max[b] || (_max[a] == _max[b] && a < b); });
+
+			_active.clear();
+			_activePos.assign(count, inactive);
+			for(uint32_t t = 0; t < count; t++)
+				if(_min[t] <= offset && offset < _max[t])
+					activate(t);
+
+			_offset = offset;
+			_minCursor = cursor(_byMin, _min, offset);
+			_maxCursor = cursor(_byMax, _max, offset);
+			_built = true;
+		}
+
+		// The amount of entries in `sorted` with `values[entry] <= offset`.
+		static size_t cursor(const std::vector<uint32_t>& sorted, const std::vector<float>& values, float offset)
+		{
+			return std::upper_bound(sorted.begin(), sorted.end(), offset, [&](float o, uint32_t t) { return o < values[t]; }) - sorted.begin();
+		}
+
+		// Updates the active set for a new offset, only touching the tetrahedra whose ranges start or end in between.
+		void moveTo(float offset)
+		{
+			if(offset == _offset) return;
+
+			size_t minCursor = cursor(_byMin, _min, offset);
+			size_t maxCursor = cursor(_byMax, _max, offset);
+
+			if(offset > _offset)
+			{
+				// ranges starting in (old, new] begin crossing, ranges ending in (old, new] stop
+				for(size_t i = _minCursor; i < minCursor; i++)
+					activate(_byMin[i]);
+				for(size_t i = _maxCursor; i < maxCursor; i++)
+					deactivate(_byMax[i]);
+			}
+			else
+			{
+				// ranges ending in (new, old] cross again, ranges starting in (new, old] stop
+				for(size_t i = maxCursor; i < _maxCursor; i++)
+					activate(_byMax[i]);
+				for(size_t i = minCursor; i < _minCursor; i++)
+					deactivate(_byMin[i]);
+			}
+
+			_offset = offset;
+			_minCursor = minCursor;
+			_maxCursor = maxCursor;
+		}
+
+	public:
+		/**
+		 * @param normal The normal of the hyperplanes this index will be used for. Doesn't have to be normalized.
+		 */
+		SliceIndex(const Point& normal = { 0,0,0,1 }) : _normal(normal) {}
+
+		const Point& getNormal() const { return _normal; }
+		// Changes the normal. The index gets rebuilt on its next use.
+		void setNormal(const Point& normal)
+		{
+			_normal = normal;
+			_built = false;
+		}
+
+		// Forces a rebuild on the next use.
+		void invalidate() { _built = false; }
+
+		// The tetrahedra crossing the offset used last, in no particular order.
+		const std::vector<uint32_t>& getActive() const { return _active; }
+	};
+}
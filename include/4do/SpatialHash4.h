@@ -0,0 +1,187 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Point.h"
+#include "Parallel.h"
+
+namespace fdo
+{
+	/**
+	 * A hashed uniform grid over a set of 4D points (usually `Object::vertices`), for radius queries.
+	 * It only stores point indices; the points themselves are passed to every call, so they have to be the same
+	 * (or extended, see `insert`) between calls. Queries return indices into them.
+	 * Works best when the cell size is about the query radius.
+	 */
+	class SpatialHash4
+	{
+	private:
+		float _cellSize = 1.f;
+		float _invCellSize = 1.f;
+		size_t _tableMask = 0;
+		std::vector<uint32_t> _bucketStart; // CSR offsets into _entries, one past the last bucket included
+		std::vector<uint32_t> _entries; // point indices, grouped by bucket
+		std::vector<uint32_t> _pending; // inserted since the last rebuild, scanned linearly by queries
+		size_t _count = 0; // amount of points indexed, including the pending ones
+
+		std::array<int32_t, 4> cellOf(const Point& p) const
+		{
+			auto c = [this](float v)
+				{
+					float f = std::floor(v * _invCellSize);
+					return (int32_t)std::clamp(f, -2147483520.f, 2147483520.f);
+				};
+			return { c(p.x), c(p.y), c(p.z), c(p.w) };
+		}
+		size_t bucketOf(const std::array<int32_t, 4>& cell) const
+		{
+			uint64_t h = (uint64_t)(uint32_t)cell[0] * 0x9E3779B97F4A7C15ull;
+			h ^= (uint64_t)(uint32_t)cell[1] * 0xC2B2AE3D27D4EB4Full;
+			h ^= (uint64_t)(uint32_t)cell[2] * 0x165667B19E3779F9ull;
+			h ^= (uint64_t)(uint32_t)cell[3] * 0x27D4EB2F165667C5ull;
+			h ^= h >> 29;
+			return (size_t)h & _tableMask;
+		}
+
+	public:
+		SpatialHash4() = default;
+		/**
+		 * @param points The points to index.
+		 * @param cellSize The edge length of the grid cells.
+		 */
+		SpatialHash4(std::span<const Point> points, float cellSize) { build(points, cellSize); }
+
+		float getCellSize() const { return _cellSize; }
+		// The amount of points indexed.
+		size_t size() const { return _count; }
+
+		/**
+		 * (Re)builds the grid over all `points`. Hashing runs in parallel.
+		 * @param cellSize The edge length of the grid cells. Must be positive.
+		 */
+		void build(std::span<const Point> points, float cellSize)
+		{
+			_cellSize = cellSize > 0.f ? cellSize : 1.f;
+			_invCellSize = 1.f / _cellSize;
+			_count = points.size();
+			_pending.clear();
+
+			size_t tableSize = 1;
+			while(tableSize < points.size() * 2)
+				tableSize <<= 1;
+			_tableMask = tableSize - 1;
+
+			std::vector<uint32_t> buckets(points.size());
+			Parallel::forChunks(points.size(), [&](size_t begin, size_t end)
+				{
+					for(size_t i = begin; i < end; i++)
+						buckets[i] = (uint32_t)bucketOf(cellOf(points[i]));
+				});
+
+			// counting sort by bucket, stable so every bucket lists its points in index order
+			_bucketStart.assign(tableSize + 1, 0);
+			for(uint32_t b : buckets)
+				_bucketStart[b + 1]++;
+			for(size_t i = 1; i <= tableSize; i++)
+				_bucketStart[i] += _bucketStart[i - 1];
+			_entries.resize(points.size());
+			std::vector<uint32_t> cursor(_bucketStart.begin(), _bucketStart.end() - 1);
+			for(uint32_t i = 0; i < points.size(); i++)
+				_entries[cursor[buckets[i]]++] = i;
+		}
+
+		/**
+		 * Indexes the points added to the end of `points` since the last `build` or `insert`
+		 * (e.g. after `Object::pushVertex`). Cheap per call; rebuilds the grid once enough points piled up.
+		 */
+		void insert(std::span<const Point> points)
+		{
+			for(size_t i = _count; i < points.size(); i++)
+				_pending.push_back((uint32_t)i);
+			_count = std::max(_count, points.size());
+			if(_pending.size() > 1024 && _pending.size() * 8 > _entries.size())
+				build(points, _cellSize);
+		}
+
+		/**
+		 * Finds the points within `radius` of `center`.
+		 * @param out The point indices, in ascending order. Gets cleared first.
+		 */
+		void radius(std::span<const Point> points, const Point& center, float radius, std::vector<uint32_t>& out) const
+		{
+			std::vector<uint32_t> buckets;
+			this->radius(points, center, radius, out, buckets);
+		}
+		/**
+		 * Same as above, with the buckets to visit listed in `buckets`. Reuse it between calls to avoid allocations.
+		 */
+		void radius(std::span<const Point> points, const Point& center, float radius, std::vector<uint32_t>& out, std::vector<uint32_t>& buckets) const
+		{
+			out.clear();
+			const float rSqr = radius * radius;
+			auto test = [&](uint32_t i)
+				{
+					if(i < points.size() && Point::lengthSqr(points[i] - center) <= rSqr)
+						out.push_back(i);
+				};
+
+			if(!_entries.empty() && radius >= 0.f)
+			{
+				const auto lo = cellOf(center - radius);
+				const auto hi = cellOf(center + radius);
+				double cells = 1;
+				for(int i = 0; i < 4; i++)
+					cells *= (double)hi[i] - lo[i] + 1;
+				if(cells > (double)_bucketStart.size())
+				{
+					// the query covers more cells than there are buckets, just scan everything
+					for(uint32_t i : _entries)
+						test(i);
+				}
+				else
+				{
+					// different cells can share a bucket, visit every bucket once
+					buckets.clear();
+					std::array<int32_t, 4> c;
+					for(c[0] = lo[0]; c[0] <= hi[0]; c[0]++)
+						for(c[1] = lo[1]; c[1] <= hi[1]; c[1]++)
+							for(c[2] = lo[2]; c[2] <= hi[2]; c[2]++)
+								for(c[3] = lo[3]; c[3] <= hi[3]; c[3]++)
+									buckets.push_back((uint32_t)bucketOf(c));
+					std::sort(buckets.begin(), buckets.end());
+					buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+
+					for(uint32_t b : buckets)
+						for(uint32_t j = _bucketStart[b]; j < _bucketStart[b + 1]; j++)
+							test(_entries[j]);
+				}
+			}
+			for(uint32_t i : _pending)
+				test(i);
+
+			std::sort(out.begin(), out.end());
+		}
+
+		/**
+		 * Finds the point closest to `center`, looking no further than `radius`.
+		 * @returns The point index, or -1 if there's none within `radius`. Ties go to the lower index.
+		 */
+		int32_t nearest(std::span<const Point> points, const Point& center, float radius) const
+		{
+			std::vector<uint32_t> candidates;
+			this->radius(points, center, radius, candidates);
+
+			int32_t best = -1;
+			float bestDist = std::numeric_limits<float>::infinity();
+			for(uint32_t i : candidates)
+			{
+				float d = Point::lengthSqr(points[i] - center);
+				if(d < bestDist)
+				{
+					bestDist = d;
+					best = (int32_t)i;
+				}
+			}
+			return best;
+		}
+	};
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Format.h"
+#include "Point.h"
+#include "TexCoord.h"
+#include "Color.h"
+#include "Dedup.h"
+#include "DedupTable.h"
+#include "TetrahedralizeScratch.h"
+
+namespace fdo
+{
+	class Object;
+
+	/**
+	 * Keeps the result of Object::tetrahedralize between calls, so an edited Object only redoes the parts that changed.
+	 * After every update, `getChangedIndices` and `getChangedVertices` list what's new, for partial GPU buffer updates.
+	 * Changes to the Object are found through the version stamps of its buffers. A changed attribute buffer counts as
+	 * entirely changed unless the edited ranges were marked with `markDirty` first; growing or shrinking buffers is
+	 * picked up on its own. Unmarked changes to the tetrahedra cost a pass comparing every corner with the context,
+	 * marking them with `markTetrahedra` skips that.
+	 * Vertices no corner uses anymore stay in the buffers (they're harmless to draw with) until there are enough of them
+	 * to trigger a full rebuild.
+	 */
+	class TetrahedralizeContext
+	{
+	public:
+		// A range of elements, [begin, end).
+		struct Range
+		{
+			size_t begin = 0;
+			size_t end = 0;
+		};
+
+	private:
+		friend class Object;
+
+		// Hashes and compares the vertices in the context, like Object::CornerKeys does for tetrahedron corners.
+		struct VertexKeys
+		{
+			const TetrahedralizeContext* context = nullptr;
+
+			uint64_t operator()(uint32_t vertex) const
+			{
+				const TetrahedralizeContext& c = *context;
+				if(c._dedup == Dedup::ByIndex)
+					return hashVertexIndices(c._tuples[vertex]);
+				return hashVertexValues(c._attributes,
+					c._positions.empty() ? Point{ 0,0,0,0 } : c._positions[vertex],
+					c._normals.empty() ? Point{ 0,0,0,0 } : c._normals[vertex],
+					c._texCoords.empty() ? TexCoord{ 0,0,0 } : c._texCoords[vertex],
+					c._colors.empty() ? Color{ 0,0,0,0 } : c._colors[vertex]);
+			}
+			bool operator()(uint32_t a, uint32_t b) const
+			{
+				const TetrahedralizeContext& c = *context;
+				if(c._dedup == Dedup::ByIndex)
+					return c._tuples[a] == c._tuples[b];
+				return (c._positions.empty() || c._positions[a] == c._positions[b])
+					&& (c._normals.empty() || c._normals[a] == c._normals[b])
+					&& (c._texCoords.empty() || c._texCoords[a] == c._texCoords[b])
+					&& (c._colors.empty() || c._colors[a] == c._colors[b]);
+			}
+		};
+
+		// buffers of the Object, in the order tetrahedra, vertices, normals, texCoords, colors
+		inline static constexpr size_t bufferCount = 5;
+
+		DataMask _attributes = DataMask::All;
+		Dedup _dedup = Dedup::ByIndex;
+
+		bool _built = false;
+		uint64_t _versions[bufferCount]{};
+		size_t _sizes[bufferCount]{};
+		std::vector<Range> _marked[bufferCount];
+
+		std::vector<uint32_t> _indexBuffer;
+		std::vector<Point> _positions;
+		std::vector<Point> _normals;
+		std::vector<TexCoord> _texCoords;
+		std::vector<Color> _colors;
+
+		std::vector<std::array<int32_t, 4>> _tuples; // (v, vn, vt, co) indices of every vertex, -1 where invalid or not requested
+		std::vector<uint32_t> _references; // amount of corners using every vertex
+		size_t _unreferenced = 0;
+		DedupTable<uint32_t, VertexKeys, VertexKeys> _table; // keys are vertex indices
+
+		bool _rebuilt = false;
+		std::vector<Range> _changedIndices;
+		std::vector<Range> _changedVertices;
+
+		// scratch
+		std::vector<uint8_t> _dirtyCorners;
+		std::vector<uint8_t> _dirtyAttributes[4];
+		std::vector<uint8_t> _changedVertexFlags;
+		TetrahedralizeScratch _scratch; // for rebuilds
+
+		// Appends `i` to a list of ascending ranges, extending the last one when possible.
+		static void addChange(std::vector<Range>& ranges, size_t i)
+		{
+			if(!ranges.empty() && ranges.back().end == i)
+				ranges.back().end++;
+			else
+				ranges.push_back({ i, i + 1 });
+		}
+
+	public:
+		/**
+		 * @param attributes Which outputs to produce.
+		 * @param dedup How to merge the corners into shared vertices.
+		 */
+		TetrahedralizeContext(DataMask attributes = DataMask::All, Dedup dedup = Dedup::ByIndex) : _attributes(attributes), _dedup(dedup) {}
+
+		// The context points into itself, copies would have to rebuild anyway.
+		TetrahedralizeContext(const TetrahedralizeContext&) = delete;
+		TetrahedralizeContext& operator=(const TetrahedralizeContext&) = delete;
+
+		DataMask getAttributes() const { return _attributes; }
+		// Changes which outputs to produce. The next update rebuilds everything.
+		void setAttributes(DataMask attributes)
+		{
+			_attributes = attributes;
+			_built = false;
+		}
+		Dedup getDedup() const { return _dedup; }
+		// Changes how corners get merged. The next update rebuilds everything.
+		void setDedup(Dedup dedup)
+		{
+			_dedup = dedup;
+			_built = false;
+		}
+
+		// Forces a full rebuild on the next update.
+		void invalidate() { _built = false; }
+
+		// Marks the tetrahedra in [begin, end) as changed, so the next update only redoes those.
+		void markTetrahedra(size_t begin, size_t end)
+		{
+			if(begin < end)
+				_marked[0].push_back({ begin, end });
+		}
+		// Marks the elements in [begin, end) of the buffer holding `type` data as changed, so the next update only redoes those.
+		void markDirty(FDataType type, size_t begin, size_t end)
+		{
+			if(type != FDataType::None && begin < end)
+				_marked[(size_t)type].push_back({ begin, end });
+		}
+
+		const std::vector<uint32_t>& getIndexBuffer() const { return _indexBuffer; }
+		// Empty unless positions were requested. Same goes for the other outputs.
+		const std::vector<Point>& getPositions() const { return _positions; }
+		const std::vector<Point>& getNormals() const { return _normals; }
+		const std::vector<TexCoord>& getTexCoords() const { return _texCoords; }
+		const std::vector<Color>& getColors() const { return _colors; }
+		size_t getVertexCount() const { return _tuples.size(); }
+
+		// Whether the last update rebuilt everything, instead of only the parts that changed.
+		bool wasRebuilt() const { return _rebuilt; }
+		// The parts of the index buffer the last update wrote, ascending. The buffer may also have gotten shorter.
+		const std::vector<Range>& getChangedIndices() const { return _changedIndices; }
+		// The vertices the last update wrote (in every output), ascending.
+		const std::vector<Range>& getChangedVertices() const { return _changedVertices; }
+	};
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Format.h"
+#include "Point.h"
+#include "TexCoord.h"
+#include "Color.h"
+#include "Tetrahedron.h"
+#include "Dedup.h"
+#include "DedupTable.h"
+
+namespace fdo
+{
+	class Object;
+
+	// Hashes and compares tetrahedron corners (`tetrahedronIndex * 4 + vertex`) by the vertex they turn into in Object::tetrahedralize.
+	// With `points` set, corners index those instead (the polyline points in Object::linearize).
+	struct CornerKeys
+	{
+		DataMask attributes = DataMask::None;
+		Dedup dedup = Dedup::ByIndex;
+		const Tetrahedron* tets = nullptr;
+		const std::array<int32_t, 4>* points = nullptr; // already checked and masked like `indices` does
+		std::span<const Point> verts;
+		std::span<const Point> norms;
+		std::span<const TexCoord> uvws;
+		std::span<const Color> cols;
+
+		CornerKeys() = default;
+		CornerKeys(std::span<const Tetrahedron> tets, std::span<const Point> verts, std::span<const Point> norms, std::span<const TexCoord> uvws, std::span<const Color> cols, DataMask attributes, Dedup dedup) :
+			attributes(attributes), dedup(dedup), tets(tets.data()), verts(verts), norms(norms), uvws(uvws), cols(cols)
+		{
+			// indices of data that wasn't requested are ignored
+			if(!(uint8_t)(attributes & DataMask::v)) this->verts = {};
+			if(!(uint8_t)(attributes & DataMask::vn)) this->norms = {};
+			if(!(uint8_t)(attributes & DataMask::vt)) this->uvws = {};
+			if(!(uint8_t)(attributes & DataMask::co)) this->cols = {};
+		}
+
+		// The attribute indices of `corner`, -1 where invalid or not requested.
+		std::array<int32_t, 4> indices(uint32_t corner) const
+		{
+			if(points)
+				return points[corner];
+			const Tetrahedron& tet = tets[corner / 4];
+			const int vertex = corner % 4;
+			auto checked = [](int32_t index, size_t size) -> int32_t { return index >= 0 && (size_t)index < size ? index : -1; };
+			return
+			{
+				checked(tet.vIndices[vertex], verts.size()),
+				checked(tet.vnIndices[vertex], norms.size()),
+				checked(tet.vtIndices[vertex], uvws.size()),
+				checked(tet.coIndices[vertex], cols.size()),
+			};
+		}
+
+		uint64_t operator()(uint32_t corner) const
+		{
+			const std::array<int32_t, 4> t = indices(corner);
+			if(dedup == Dedup::ByIndex)
+				return hashVertexIndices(t);
+			// by value, missing data counts as zeroes
+			return hashVertexValues(attributes,
+				t[0] >= 0 ? verts[t[0]] : Point{ 0,0,0,0 },
+				t[1] >= 0 ? norms[t[1]] : Point{ 0,0,0,0 },
+				t[2] >= 0 ? uvws[t[2]] : TexCoord{ 0,0,0 },
+				t[3] >= 0 ? cols[t[3]] : Color{ 0,0,0,0 });
+		}
+
+		bool operator()(uint32_t a, uint32_t b) const
+		{
+			const std::array<int32_t, 4> ta = indices(a);
+			const std::array<int32_t, 4> tb = indices(b);
+			if(dedup == Dedup::ByIndex)
+				return ta == tb;
+
+			// equal indices (including both missing) mean equal values, except for NaNs which never equal anything
+			auto same = [](int32_t ia, int32_t ib, auto data, auto zero)
+				{
+					return (ia >= 0 ? data[ia] : zero) == (ib >= 0 ? data[ib] : zero);
+				};
+			return same(ta[0], tb[0], verts, Point{ 0,0,0,0 })
+				&& same(ta[1], tb[1], norms, Point{ 0,0,0,0 })
+				&& same(ta[2], tb[2], uvws, TexCoord{ 0,0,0 })
+				&& same(ta[3], tb[3], cols, Color{ 0,0,0,0 });
+		}
+	};
+
+
+	/**
+	 * Working memory for Object::tetrahedralize and Object::linearize. Pass the same one to every call (for any Object) and its buffers and
+	 * hash tables get reused, so converting in a loop stops allocating once they're big enough.
+	 * Only one call can use it at a time.
+	 */
+	class TetrahedralizeScratch
+	{
+	private:
+		friend class Object;
+
+		struct Local
+		{
+			DedupTable<uint32_t, CornerKeys, CornerKeys> table; // the vertices of one chunk of corners
+			std::vector<uint32_t> toGlobal; // local -> global vertex index
+		};
+
+		DedupTable<uint32_t, CornerKeys, CornerKeys> _table;
+		std::vector<Local> _locals;
+		std::vector<uint32_t> _corners; // first corner of every vertex
+		std::vector<uint32_t> _indexBuffer; // for the overloads not writing into a std::vector
+
+		// for Object::tetrahedralizeCells
+		std::vector<uint32_t> _cellTetrahedra; // the tetrahedra in index buffer order
+		std::vector<uint8_t> _inCell; // whether a tetrahedron is in any cell
+		std::vector<uint32_t> _tetletSlots; // where every vertex was last added to Tetlets::vertices
+
+		// polylines flattened for Object::linearize, polylines shorter than 2 points count as empty
+		std::vector<uint32_t> _pointOffsets; // first point of every polyline, plus the total
+		std::vector<uint32_t> _segmentOffsets; // first segment of every polyline, plus the total
+		std::vector<std::array<int32_t, 4>> _points; // (v, vn, vt, co) indices of every point, -1 where invalid or not requested
+		std::vector<uint32_t> _pointVertices; // the vertex of every point
+
+	public:
+		TetrahedralizeScratch() = default;
+
+		// Frees all the memory.
+		void release() { *this = TetrahedralizeScratch(); }
+	};
+}
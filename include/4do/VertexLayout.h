@@ -0,0 +1,190 @@
+#pragma once
+
+#include "basicIncludes.h"
+#include "Format.h"
+#include "SIMD.h"
+
+namespace fdo
+{
+	// How a vertex attribute is stored in a vertex buffer.
+	enum class VertexFormat : uint8_t
+	{
+		Float32x4, // 4 floats.
+		Float32x3, // 3 floats, the 4th component gets dropped.
+		Float32x2, // 2 floats, e.g. plain UVs.
+		Unorm8x4, // 4 bytes, mapping [0, 1] to [0, 255]. Colors get stored as-is.
+		Float16x4, // 4 half floats.
+		Float16x2, // 2 half floats.
+		Snorm16x4, // 4 shorts, mapping [-1, 1] to [-32767, 32767]. For normals.
+		Snorm8x4, // 4 bytes, mapping [-1, 1] to [-127, 127]. For normals.
+	};
+	// The size of one attribute stored in `format`, in bytes.
+	inline constexpr uint32_t vertexFormatSize(VertexFormat format)
+	{
+		switch(format)
+		{
+		case VertexFormat::Float32x4: return 16;
+		case VertexFormat::Float32x3: return 12;
+		case VertexFormat::Float32x2: return 8;
+		case VertexFormat::Unorm8x4: return 4;
+		case VertexFormat::Float16x4: return 8;
+		case VertexFormat::Float16x2: return 4;
+		case VertexFormat::Snorm16x4: return 8;
+		case VertexFormat::Snorm8x4: return 4;
+		}
+		return 0;
+	}
+
+	// How many attributes encodeVertexFormat and encodeIndices convert per step, sized to stay on the stack.
+	inline constexpr size_t encodeBatchSize = 64;
+
+	/**
+	 * Encodes `count` attributes from `src` (4 floats each, tightly packed) into `format`.
+	 * Rounds to nearest even, and clamps the normalized formats into their range.
+	 * @param dst Where the first attribute goes. Doesn't have to be aligned.
+	 * @param stride The distance between consecutive attributes in `dst`, in bytes.
+	 */
+	inline void encodeVertexFormat(VertexFormat format, const float* src, size_t count, std::byte* dst, size_t stride)
+	{
+		const uint32_t size = vertexFormatSize(format);
+		if(format == VertexFormat::Float32x4 || format == VertexFormat::Float32x3 || format == VertexFormat::Float32x2)
+		{
+			for(size_t i = 0; i < count; i++)
+				std::memcpy(dst + i * stride, src + i * 4, size);
+			return;
+		}
+
+		// encode a batch into packed 4-component elements, then scatter the components the format keeps
+		alignas(16) std::byte packed[encodeBatchSize * 8];
+		for(size_t first = 0; first < count; first += encodeBatchSize)
+		{
+			const size_t n = std::min(encodeBatchSize, count - first);
+			const float* in = src + first * 4;
+			size_t elementSize = 4;
+			switch(format)
+			{
+			case VertexFormat::Float16x4:
+			case VertexFormat::Float16x2:
+				simd::toHalf4(in, n, (uint16_t*)packed);
+				elementSize = 8;
+				break;
+			case VertexFormat::Snorm16x4:
+				simd::toSnorm16x4(in, n, (int16_t*)packed);
+				elementSize = 8;
+				break;
+			case VertexFormat::Snorm8x4:
+				simd::toSnorm8x4(in, n, (int8_t*)packed);
+				break;
+			default:
+				simd::toUnorm8x4(in, n, (uint8_t*)packed);
+				break;
+			}
+
+			std::byte* out = dst + first * stride;
+			if(stride == size && elementSize == size)
+				std::memcpy(out, packed, n * size);
+			else
+				for(size_t i = 0; i < n; i++)
+					std::memcpy(out + i * stride, packed + i * elementSize, size);
+		}
+	}
+
+	// The type of the indices in an index buffer.
+	enum class IndexFormat : uint8_t
+	{
+		UInt32,
+		UInt16, // Only works for up to 65536 vertices.
+		Auto, // UInt16 when the vertices fit, otherwise UInt32.
+	};
+
+	/**
+	 * Writes 32-bit `indices` to `dst` as `format` (UInt32 or UInt16).
+	 * Expects every index to fit into the format and `dst` to be big enough.
+	 */
+	inline void encodeIndices(std::span<const uint32_t> indices, IndexFormat format, std::byte* dst)
+	{
+		if(format == IndexFormat::UInt16)
+		{
+			uint16_t packed[encodeBatchSize * 4];
+			for(size_t first = 0; first < indices.size(); first += encodeBatchSize * 4)
+			{
+				const size_t n = std::min(encodeBatchSize * 4, indices.size() - first);
+				simd::narrow16(indices.data() + first, n, packed);
+				std::memcpy(dst + first * 2, packed, n * 2);
+			}
+		}
+		else
+			std::memcpy(dst, indices.data(), indices.size() * 4);
+	}
+
+	// One attribute of an interleaved vertex.
+	struct VertexAttribute
+	{
+		FDataType type = FDataType::v;
+		VertexFormat format = VertexFormat::Float32x4;
+		uint32_t offset = 0; // Where the attribute starts inside a vertex, in bytes.
+	};
+
+	/**
+	 * Describes an interleaved vertex buffer (see Object::tetrahedralize): which attributes every vertex has,
+	 * how they're stored and where. Either fill in the offsets and stride yourself (e.g. to match alignment rules),
+	 * or let `add` pack the attributes tightly.
+	 */
+	struct VertexLayout
+	{
+		std::vector<VertexAttribute> attributes;
+		uint32_t stride = 0; // The distance between consecutive vertices, in bytes.
+
+		VertexLayout() = default;
+		VertexLayout(const std::vector<VertexAttribute>& attributes, uint32_t stride) : attributes(attributes), stride(stride) {}
+
+		// Appends an attribute right after the end of the vertex, growing the stride.
+		VertexLayout& add(FDataType type, VertexFormat format)
+		{
+			attributes.push_back({ type, format, stride });
+			stride += vertexFormatSize(format);
+			return *this;
+		}
+
+		// The kinds of data the layout stores.
+		DataMask mask() const
+		{
+			DataMask result = DataMask::None;
+			for(auto& a : attributes)
+				switch(a.type)
+				{
+				case FDataType::v: result |= DataMask::v; break;
+				case FDataType::vn: result |= DataMask::vn; break;
+				case FDataType::vt: result |= DataMask::vt; break;
+				case FDataType::co: result |= DataMask::co; break;
+				default: break;
+				}
+			return result;
+		}
+
+		// The size of `vertexCount` vertices, in bytes.
+		size_t bytes(size_t vertexCount) const { return vertexCount * stride; }
+
+		// Whether every attribute has a type and fits inside the stride.
+		bool isValid() const
+		{
+			if(attributes.empty())
+				return false;
+			for(auto& a : attributes)
+				if(a.type == FDataType::None || (size_t)a.offset + vertexFormatSize(a.format) > stride)
+					return false;
+			return true;
+		}
+	};
+
+	// What Object::tetrahedralize (or Object::linearize) wrote to caller-owned index and vertex buffers, or needs to.
+	struct TetrahedralizeInfo
+	{
+		size_t vertexCount = 0;
+		size_t indexCount = 0;
+		IndexFormat indexFormat = IndexFormat::UInt32; // The format the indices are (or would be) in. Never Auto.
+		size_t vertexBytes = 0; // The size of the vertex data.
+		size_t indexBytes = 0; // The size of the index data.
+		bool written = false; // `false` if a buffer was too small or something was invalid. The rest is still set when possible.
+	};
+}
@@ -20,6 +20,17 @@
 #include <set>
 #include <locale>
 #include <functional>
+#include <utility>
+#include <span>
+#include <type_traits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <bit>
 
 // utils (mostly for strings)
 namespace fdo::utils